@@ -1,20 +1,47 @@
 TEMPLATE = app
-CONFIG += console c++17
+CONFIG += console c++2a
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
         tests/main.cpp \
         tests/run_suits.cpp \
+        tests/file_modes.cpp \
     gf256-3rd-party/gf256.cpp
 
 HEADERS += \
     GF256/GF256.hpp \
     GF256/impl/representations.hpp \
+    GF256/impl/bulk.hpp \
+    GF256/impl/crc32c.hpp \
+    GF256/impl/spsc_queue.hpp \
+    GF256/impl/xor_schedule.hpp \
+    GF256/impl/bitplane.hpp \
+    GF256/impl/clmul.hpp \
+    GF256/impl/gemm.hpp \
+    GF256/impl/greased.hpp \
+    GF256/impl/basis.hpp \
+    GF256/Matrix.hpp \
+    GF256/SparseMatrix.hpp \
+    GF256/Tower.hpp \
+    GF256/ReedSolomon.hpp \
+    GF256/FixedReedSolomon.hpp \
+    GF256/BitmatrixCodec.hpp \
+    GF256/ConstantTime.hpp \
+    GF256/LRC.hpp \
+    GF256/MSR.hpp \
+    GF256/StreamEncoder.hpp \
+    GF256/ShardIO.hpp \
+    GF256/AsyncCodec.hpp \
+    GF256/JitEncoder.hpp \
+    GF256/Vec.hpp \
+    GF256/Buffer.hpp \
     tests/run_suits.hpp \
+    tests/file_modes.hpp \
     gf256-3rd-party/gf256.h
 
-QMAKE_CXXFLAGS += -msse4.1
+QMAKE_CXXFLAGS += -msse4.2
+LIBS += -pthread
 
 QMAKE_CXXFLAGS_RELEASE -= -O1
 QMAKE_CXXFLAGS_RELEASE -= -O2
@@ -0,0 +1,220 @@
+#ifndef GF256_ASYNC_CODEC_HPP
+#define GF256_ASYNC_CODEC_HPP
+
+#include "ReedSolomon.hpp"
+
+#include <algorithm>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace GF256
+{
+
+template <class T>
+class Task;
+
+namespace task_impl
+{
+struct PromiseBase
+{
+  std::coroutine_handle<> continuation;
+
+  struct FinalAwaiter
+  {
+    bool await_ready () noexcept {return false;}
+
+    template <class Promise>
+    std::coroutine_handle<> await_suspend (std::coroutine_handle<Promise> finished) noexcept
+    {
+      std::coroutine_handle<> next = finished.promise ().continuation;
+      return next ? next : std::noop_coroutine ();
+    }
+
+    void await_resume () noexcept {}
+  };
+
+  std::suspend_always initial_suspend () noexcept {return {};}
+  FinalAwaiter final_suspend () noexcept {return {};}
+  void unhandled_exception () {std::terminate ();}
+};
+
+template <class T>
+struct Promise : PromiseBase
+{
+  std::optional<T> value;
+
+  Task<T> get_return_object ();
+  void return_value (T result) {value = std::move (result);}
+  T take () {return std::move (*value);}
+};
+
+template <>
+struct Promise<void> : PromiseBase
+{
+  Task<void> get_return_object ();
+  void return_void () {}
+  void take () {}
+};
+} //namespace task_impl
+
+// Lazily started coroutine. Awaiting it from another coroutine starts it and resumes the awaiting one
+// when it finishes; a top-level task is started with start () and driven by whatever executor it schedules on.
+template <class T>
+class Task
+{
+public:
+  using promise_type = task_impl::Promise<T>;
+
+private:
+  std::coroutine_handle<promise_type> m_handle;
+
+public:
+  explicit Task (std::coroutine_handle<promise_type> handle) : m_handle (handle) {}
+  Task (Task &&other) : m_handle (std::exchange (other.m_handle, nullptr)) {}
+  Task (const Task &) = delete;
+  Task &operator = (const Task &) = delete;
+
+  ~Task ()
+  {
+    if (m_handle)
+      m_handle.destroy ();
+  }
+
+  void start ()      {m_handle.resume ();}
+  bool done () const {return m_handle.done ();}
+  T result ()        {return m_handle.promise ().take ();}
+
+  bool await_ready () const {return false;}
+
+  std::coroutine_handle<> await_suspend (std::coroutine_handle<> awaiting)
+  {
+    m_handle.promise ().continuation = awaiting;
+    return m_handle;
+  }
+
+  T await_resume () {return m_handle.promise ().take ();}
+};
+
+template <class T>
+Task<T> task_impl::Promise<T>::get_return_object ()
+{
+  return Task<T> (std::coroutine_handle<Promise<T>>::from_promise (*this));
+}
+
+inline Task<void> task_impl::Promise<void>::get_return_object ()
+{
+  return Task<void> (std::coroutine_handle<Promise<void>>::from_promise (*this));
+}
+
+// co_await schedule (executor) suspends the coroutine and lets the executor resume it later.
+// Any type with post (std::coroutine_handle<>) is an executor.
+template <class Executor>
+struct ScheduleAwaiter
+{
+  Executor &executor;
+
+  bool await_ready () const {return false;}
+  void await_suspend (std::coroutine_handle<> handle) {executor.post (handle);}
+  void await_resume () {}
+};
+
+template <class Executor>
+ScheduleAwaiter<Executor> schedule (Executor &executor)
+{
+  return {executor};
+}
+
+// Minimal FIFO executor for tests and single-threaded event loops. post () may be called from any thread.
+class QueueExecutor
+{
+  std::mutex m_mutex;
+  std::deque<std::coroutine_handle<>> m_ready;
+
+public:
+  void post (std::coroutine_handle<> handle)
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_ready.push_back (handle);
+  }
+
+  bool run_one ()
+  {
+    std::coroutine_handle<> handle;
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (m_ready.empty ())
+        return false;
+
+      handle = m_ready.front ();
+      m_ready.pop_front ();
+    }
+
+    handle.resume ();
+    return true;
+  }
+
+  // Resumes coroutines until none is ready, returns how many were resumed.
+  int run ()
+  {
+    int resumed = 0;
+    while (run_one ())
+      resumed++;
+    return resumed;
+  }
+};
+
+// Encodes chunk_len > 0 bytes at a time and yields to the executor between chunks,
+// so a large stripe never holds the event loop for longer than one chunk.
+template <class Executor>
+Task<void> encode_async (Executor &executor, const ReedSolomon &codec, std::vector<const Element *> data,
+                         std::vector<Element *> parity, size_t len, size_t chunk_len = 64 << 10)
+{
+  if (chunk_len == 0)
+    std::terminate (); // the stripe would never advance
+
+  std::vector<const Element *> data_chunk (data.size ());
+  std::vector<Element *> parity_chunk (parity.size ());
+
+  for (size_t offset = 0; offset < len; offset += chunk_len)
+    {
+      for (size_t i = 0; i < data.size (); i++)
+        data_chunk[i] = data[i] + offset;
+      for (size_t i = 0; i < parity.size (); i++)
+        parity_chunk[i] = parity[i] + offset;
+
+      codec.encode (data_chunk.data (), parity_chunk.data (), std::min (chunk_len, len - offset));
+      co_await schedule (executor);
+    }
+}
+
+// Chunked counterpart of ReedSolomon::reconstruct, yields to the executor between chunks.
+template <class Executor>
+Task<bool> reconstruct_async (Executor &executor, const ReedSolomon &codec, std::vector<Element *> shards,
+                              std::vector<bool> present, size_t len, size_t chunk_len = 64 << 10)
+{
+  if (chunk_len == 0)
+    std::terminate (); // the stripe would never advance
+
+  if (!codec.decoder (present))
+    co_return false;
+
+  std::vector<Element *> chunk (shards.size ());
+  for (size_t offset = 0; offset < len; offset += chunk_len)
+    {
+      for (size_t i = 0; i < shards.size (); i++)
+        chunk[i] = shards[i] + offset;
+
+      codec.reconstruct (chunk.data (), present, std::min (chunk_len, len - offset));
+      co_await schedule (executor);
+    }
+
+  co_return true;
+}
+
+} //namespace GF256
+
+#endif // GF256_ASYNC_CODEC_HPP
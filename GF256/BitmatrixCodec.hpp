@@ -0,0 +1,154 @@
+#ifndef GF256_BITMATRIX_CODEC_HPP
+#define GF256_BITMATRIX_CODEC_HPP
+
+#include "ReedSolomon.hpp"
+#include "impl/xor_schedule.hpp"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace GF256
+{
+
+// Cauchy Reed-Solomon on bit planes, in the manner of Jerasure: every shard is a sequence of blocks of
+// 8 packets, packet c of a block standing for bit c of every symbol, and each coefficient becomes its
+// 8x8 multiply bitmatrix. Coding is then plain XORs of whole packets, which needs no PSHUFB and scales
+// with any SIMD width. The XOR schedules are optimized once per erasure pattern.
+// Uses the Cauchy matrix of ReedSolomon (data_shards, parity_shards), but the packet layout makes the
+// parity bytes differ from it.
+class BitmatrixCodec
+{
+  ReedSolomon m_codec;
+  size_t m_packet_size = 0;
+  bool m_optimize = true;
+  XorSchedule m_encode_schedule;
+
+  mutable std::mutex m_schedules_mutex;
+  mutable std::map<std::vector<bool>, XorSchedule> m_decode_schedules; // by erasure pattern
+  mutable std::map<std::vector<bool>, XorSchedule> m_parity_schedules; // by parity part of the pattern
+
+public:
+  BitmatrixCodec (int data_shards, int parity_shards, size_t packet_size, bool optimize = true)
+    : m_codec (data_shards, parity_shards), m_packet_size (packet_size), m_optimize (optimize),
+      m_encode_schedule (make_xor_schedule (m_codec.encode_matrix ().row (data_shards), data_shards, parity_shards,
+                                            optimize))
+  {
+  }
+
+  int data_shards () const   {return m_codec.data_shards ();}
+  int parity_shards () const {return m_codec.parity_shards ();}
+  int total_shards () const  {return m_codec.total_shards ();}
+
+  // shard lengths must be multiples of block_size ()
+  size_t block_size () const {return 8 * m_packet_size;}
+
+  const XorSchedule &encode_schedule () const {return m_encode_schedule;}
+
+  // data: data_shards pointers, parity: parity_shards pointers
+  void encode (const Element *const *data, Element *const *parity, size_t len) const
+  {
+    std::vector<const Element *> inputs (data, data + data_shards ());
+    std::vector<Element *> outputs (parity, parity + parity_shards ());
+    run (m_encode_schedule, inputs, outputs, len);
+  }
+
+  // Rebuilds every shard that is not marked present. Returns false if the stripe is lost.
+  bool reconstruct (Element *const *shards, const std::vector<bool> &present, size_t len) const
+  {
+    const ReedSolomon::Decoder *dec = m_codec.decoder (present);
+    if (!dec)
+      return false;
+
+    // missing data shards from the surviving ones, then missing parity from the data
+    std::vector<const Element *> sources;
+    for (int row : dec->rows)
+      sources.push_back (shards[row]);
+
+    std::vector<Element *> missing_data;
+    for (int i = 0; i < data_shards (); i++)
+      if (!present[i])
+        missing_data.push_back (shards[i]);
+
+    if (!missing_data.empty ())
+      run (decode_schedule (present, *dec), sources, missing_data, len);
+
+    std::vector<bool> parity_present (present.begin () + data_shards (), present.end ());
+    std::vector<Element *> missing_parity;
+    for (int i = data_shards (); i < total_shards (); i++)
+      if (!present[i])
+        missing_parity.push_back (shards[i]);
+
+    if (!missing_parity.empty ())
+      {
+        std::vector<const Element *> data (shards, shards + data_shards ());
+        run (parity_schedule (parity_present), data, missing_parity, len);
+      }
+
+    return true;
+  }
+
+private:
+  void run (const XorSchedule &schedule, const std::vector<const Element *> &inputs,
+            const std::vector<Element *> &outputs, size_t len) const
+  {
+    if (len % block_size () != 0)
+      std::terminate (); // shards are whole blocks of 8 packets
+
+    std::vector<Element> temps (static_cast<size_t> (schedule.temps) * m_packet_size);
+    std::vector<Element *> symbols (schedule.inputs + schedule.temps + schedule.outputs);
+    for (int t = 0; t < schedule.temps; t++)
+      symbols[schedule.inputs + t] = temps.data () + t * m_packet_size;
+
+    // schedules only write temps and outputs, so the inputs are never modified
+    for (size_t offset = 0; offset < len; offset += block_size ())
+      {
+        for (int i = 0; i < schedule.inputs; i++)
+          symbols[i] = const_cast<Element *> (inputs[i / 8]) + offset + (i % 8) * m_packet_size;
+        for (int o = 0; o < schedule.outputs; o++)
+          symbols[schedule.inputs + schedule.temps + o] = outputs[o / 8] + offset + (o % 8) * m_packet_size;
+
+        run_xor_schedule (schedule, symbols.data (), m_packet_size);
+      }
+  }
+
+  const XorSchedule &decode_schedule (const std::vector<bool> &present, const ReedSolomon::Decoder &dec) const
+  {
+    std::lock_guard<std::mutex> lock (m_schedules_mutex);
+
+    auto it = m_decode_schedules.find (present);
+    if (it != m_decode_schedules.end ())
+      return it->second;
+
+    std::vector<int> missing;
+    for (int i = 0; i < data_shards (); i++)
+      if (!present[i])
+        missing.push_back (i);
+
+    Matrix rows = dec.inverse.select_rows (missing);
+    XorSchedule schedule = make_xor_schedule (rows.row (0), data_shards (), rows.rows (), m_optimize);
+    return m_decode_schedules.emplace (present, std::move (schedule)).first->second;
+  }
+
+  const XorSchedule &parity_schedule (const std::vector<bool> &parity_present) const
+  {
+    std::lock_guard<std::mutex> lock (m_schedules_mutex);
+
+    auto it = m_parity_schedules.find (parity_present);
+    if (it != m_parity_schedules.end ())
+      return it->second;
+
+    std::vector<int> missing;
+    for (int i = 0; i < parity_shards (); i++)
+      if (!parity_present[i])
+        missing.push_back (data_shards () + i);
+
+    Matrix rows = m_codec.encode_matrix ().select_rows (missing);
+    XorSchedule schedule = make_xor_schedule (rows.row (0), data_shards (), rows.rows (), m_optimize);
+    return m_parity_schedules.emplace (parity_present, std::move (schedule)).first->second;
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_BITMATRIX_CODEC_HPP
@@ -0,0 +1,226 @@
+#ifndef GF256_BUFFER_HPP
+#define GF256_BUFFER_HPP
+
+#include "GF256.hpp"
+#include "Vec.hpp"
+
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace GF256
+{
+
+// Element buffer whose arithmetic is lazy: a + b, c * a (c an Element) and a * b (lane by lane) build an
+// expression tree, and assigning it to a Buffer evaluates the whole tree in one loop over 32-byte blocks.
+// Intermediate results stay in registers, so z = a * x + b * y + w reads every operand once and writes z once.
+// Operands must have the same size. An expression holds references to the Buffers it reads, evaluate it
+// before they go away. Assigning to a Buffer that the expression reads is fine.
+template <class Derived>
+struct BufferExpr
+{
+  const Derived &self () const {return static_cast<const Derived &> (*this);}
+};
+
+class Buffer;
+
+namespace buffer_impl
+{
+using vec_impl::Slice;
+
+// Buffers are held by reference, expression nodes by value
+template <class E>
+using Operand = std::conditional_t<std::is_same_v<E, Buffer>, const Buffer &, E>;
+
+template <class L, class R>
+struct Sum : BufferExpr<Sum<L, R>>
+{
+  Operand<L> lhs;
+  Operand<R> rhs;
+
+  Sum (const L &l, const R &r) : lhs (l), rhs (r) {}
+
+  size_t size () const                {return lhs.size ();}
+  Slice slice (size_t offset) const   {return lhs.slice (offset) ^ rhs.slice (offset);}
+  Element at (size_t index) const     {return lhs.at (index) + rhs.at (index);}
+};
+
+// coef * operand, through the nibble tables of coef
+template <class E>
+struct Scaled : BufferExpr<Scaled<E>>
+{
+  Operand<E> operand;
+  Element coef;
+  Slice low;
+  Slice high;
+
+  Scaled (Element c, const E &e) : operand (e), coef (c)
+  {
+    NibbleTable table = make_nibble_table (c);
+    memcpy (&low, table.low, 16);
+    memcpy (&high, table.high, 16);
+  }
+
+  size_t size () const {return operand.size ();}
+
+  Slice slice (size_t offset) const
+  {
+    Slice x = operand.slice (offset);
+    return vec_impl::shuffle (low, x & 0xf) ^ vec_impl::shuffle (high, x >> 4);
+  }
+
+  Element at (size_t index) const {return coef * operand.at (index);}
+};
+
+// lane by lane product of two operands
+template <class L, class R>
+struct Product : BufferExpr<Product<L, R>>
+{
+  Operand<L> lhs;
+  Operand<R> rhs;
+
+  Product (const L &l, const R &r) : lhs (l), rhs (r) {}
+
+  size_t size () const {return lhs.size ();}
+
+  Slice slice (size_t offset) const
+  {
+    Slice a = lhs.slice (offset);
+    Slice b = rhs.slice (offset);
+    Slice result;
+    vec_impl::mul<16> (&a, &b, &result);
+    return result;
+  }
+
+  Element at (size_t index) const {return lhs.at (index) * rhs.at (index);}
+};
+
+template <class L, class R>
+inline void check_sizes (const BufferExpr<L> &lhs, const BufferExpr<R> &rhs)
+{
+  if (lhs.self ().size () != rhs.self ().size ())
+    std::terminate (); // operands of different sizes
+}
+} //namespace buffer_impl
+
+class Buffer : public BufferExpr<Buffer>
+{
+  std::vector<Element> m_elements;
+
+public:
+  Buffer () {}
+  explicit Buffer (size_t size) : m_elements (size) {}
+  explicit Buffer (std::span<const Element> elements) : m_elements (elements.begin (), elements.end ()) {}
+
+  template <class E>
+  Buffer (const BufferExpr<E> &expr) : m_elements (expr.self ().size ())
+  {
+    *this = expr;
+  }
+
+  size_t size () const {return m_elements.size ();}
+
+  Element *data ()             {return m_elements.data ();}
+  const Element *data () const {return m_elements.data ();}
+
+  Element &operator [] (size_t index)             {return m_elements[index];}
+  const Element &operator [] (size_t index) const {return m_elements[index];}
+
+  std::span<Element> span ()             {return m_elements;}
+  std::span<const Element> span () const {return m_elements;}
+
+  buffer_impl::Slice slice (size_t offset) const
+  {
+    buffer_impl::Slice result;
+    memcpy (&result, bulk_impl::bytes (data () + offset), 16);
+    return result;
+  }
+
+  Element at (size_t index) const {return m_elements[index];}
+
+  // Evaluates expr block by block. Every block is computed before it is stored,
+  // so expr may read this buffer.
+  template <class E>
+  Buffer &operator = (const BufferExpr<E> &expr)
+  {
+    const E &e = expr.self ();
+    if (e.size () != size ())
+      std::terminate (); // operands of different sizes
+
+    unsigned char *d = bulk_impl::bytes (data ());
+    size_t i = 0;
+    for (; i + 32 <= size (); i += 32)
+      {
+        buffer_impl::Slice first = e.slice (i);
+        buffer_impl::Slice second = e.slice (i + 16);
+        memcpy (d + i, &first, 16);
+        memcpy (d + i + 16, &second, 16);
+      }
+    for (; i + 16 <= size (); i += 16)
+      {
+        buffer_impl::Slice block = e.slice (i);
+        memcpy (d + i, &block, 16);
+      }
+    for (; i < size (); i++)
+      m_elements[i] = e.at (i);
+
+    return *this;
+  }
+
+  template <class E>
+  Buffer &operator += (const BufferExpr<E> &expr)
+  {
+    return *this = buffer_impl::Sum<Buffer, E> (*this, expr.self ());
+  }
+
+  template <class E>
+  Buffer &operator *= (const BufferExpr<E> &expr)
+  {
+    return *this = buffer_impl::Product<Buffer, E> (*this, expr.self ());
+  }
+
+  Buffer &operator *= (Element coef)
+  {
+    return *this = buffer_impl::Scaled<Buffer> (coef, *this);
+  }
+
+  friend bool operator == (const Buffer &lhs, const Buffer &rhs) {return lhs.m_elements == rhs.m_elements;}
+  friend bool operator != (const Buffer &lhs, const Buffer &rhs) {return !(lhs == rhs);}
+};
+
+template <class L, class R>
+inline buffer_impl::Sum<L, R> operator + (const BufferExpr<L> &lhs, const BufferExpr<R> &rhs)
+{
+  buffer_impl::check_sizes (lhs, rhs);
+  return buffer_impl::Sum<L, R> (lhs.self (), rhs.self ());
+}
+
+template <class L, class R>
+inline buffer_impl::Sum<L, R> operator - (const BufferExpr<L> &lhs, const BufferExpr<R> &rhs)
+{
+  return lhs + rhs;
+}
+
+template <class L, class R>
+inline buffer_impl::Product<L, R> operator * (const BufferExpr<L> &lhs, const BufferExpr<R> &rhs)
+{
+  buffer_impl::check_sizes (lhs, rhs);
+  return buffer_impl::Product<L, R> (lhs.self (), rhs.self ());
+}
+
+template <class E>
+inline buffer_impl::Scaled<E> operator * (Element coef, const BufferExpr<E> &expr)
+{
+  return buffer_impl::Scaled<E> (coef, expr.self ());
+}
+
+template <class E>
+inline buffer_impl::Scaled<E> operator * (const BufferExpr<E> &expr, Element coef)
+{
+  return buffer_impl::Scaled<E> (coef, expr.self ());
+}
+
+} //namespace GF256
+
+#endif // GF256_BUFFER_HPP
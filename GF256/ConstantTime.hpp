@@ -0,0 +1,312 @@
+#ifndef GF256_CONSTANT_TIME_HPP
+#define GF256_CONSTANT_TIME_HPP
+
+#include "GF256.hpp"
+#include "impl/bitplane.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace GF256
+{
+
+// Arithmetic whose timing does not depend on the values: no table lookups and no branches on elements.
+// Scalar operations multiply bit by bit through the reduction polynomial, inversion is x^254 by a fixed
+// addition chain (so zero maps to zero instead of terminating), and the region kernels bit-slice 128
+// elements per vector operation after converting to the bit-plane layout of impl/bitplane.hpp.
+// Exponents and lengths are treated as public.
+namespace ct
+{
+// low byte of the reduction polynomial: x^8 = x^7 + x^6 + x + 1 for 0x1c3
+inline constexpr unsigned char reduction = (Element (static_cast<unsigned char> (0x80))
+                                            * Element (static_cast<unsigned char> (2))).additive_rep ();
+
+inline constexpr unsigned char mul (unsigned char a, unsigned char b)
+{
+  unsigned char result = 0;
+  for (int i = 0; i < 8; i++)
+    {
+      result ^= a & static_cast<unsigned char> (-((b >> i) & 1));
+      a = static_cast<unsigned char> ((a << 1) ^ (reduction & -(a >> 7)));
+    }
+  return result;
+}
+
+inline constexpr unsigned char square (unsigned char a)
+{
+  return mul (a, a);
+}
+
+// a^254 == a^-1 for a != 0: 7 squarings and 6 multiplications, whatever a is
+inline constexpr unsigned char inv (unsigned char a)
+{
+  unsigned char a3 = mul (square (a), a);
+  unsigned char a7 = mul (square (a3), a);
+  unsigned char a15 = mul (square (a7), a);
+  unsigned char a31 = mul (square (a15), a);
+  unsigned char a63 = mul (square (a31), a);
+  unsigned char a127 = mul (square (a63), a);
+  return square (a127);
+}
+
+// a / b, zero when b is zero
+inline constexpr unsigned char div (unsigned char a, unsigned char b)
+{
+  return mul (a, inv (b));
+}
+
+// a^power, zero for a zero base as with Element::pow. The exponent is public,
+// the ladder still runs over all 8 bits of it.
+inline constexpr unsigned char pow (unsigned char a, int power)
+{
+  int exponent = power % 255;
+  if (exponent < 0)
+    exponent += 255;
+
+  unsigned char result = 1;
+  for (int i = 7; i >= 0; i--)
+    {
+      result = square (result);
+      unsigned char product = mul (result, a);
+      unsigned char take = static_cast<unsigned char> (-((exponent >> i) & 1));
+      result = static_cast<unsigned char> ((product & take) | (result & ~take));
+    }
+
+  unsigned char nonzero = static_cast<unsigned char> (-((a + 255u) >> 8));
+  return result & nonzero;
+}
+
+inline constexpr Element mul (Element a, Element b) {return Element (mul (a.additive_rep (), b.additive_rep ()));}
+inline constexpr Element div (Element a, Element b) {return Element (div (a.additive_rep (), b.additive_rep ()));}
+inline constexpr Element inv (Element a)            {return Element (inv (a.additive_rep ()));}
+inline constexpr Element pow (Element a, int power) {return Element (pow (a.additive_rep (), power));}
+
+namespace bitslice_impl
+{
+// one bit of 128 elements, an SSE2 register
+using Slice = uint64_t __attribute__ ((vector_size (16)));
+
+const size_t slice_elements = 128;
+const size_t slices_per_chunk = 16;
+const size_t chunk_elements = slice_elements * slices_per_chunk;
+const size_t plane_bytes = chunk_elements / 8;
+
+struct Chunk
+{
+  alignas (16) unsigned char planes[8][plane_bytes];
+
+  Slice slice (int bit, size_t s) const
+  {
+    Slice result;
+    memcpy (&result, planes[bit] + s * sizeof (Slice), sizeof (Slice));
+    return result;
+  }
+
+  void set_slice (int bit, size_t s, Slice value)
+  {
+    memcpy (planes[bit] + s * sizeof (Slice), &value, sizeof (Slice));
+  }
+};
+
+// Schoolbook product of the 8 bit planes, then the planes of x^14 .. x^8 folded back
+// through x^8 = x^7 + x^6 + x + 1.
+inline void mul (const Slice *a, const Slice *b, Slice *out)
+{
+  static_assert (reduction == 0xc3, "the folding below is written for the 0x1c3 polynomial");
+
+  Slice c[15] = {};
+  for (int i = 0; i < 8; i++)
+    for (int j = 0; j < 8; j++)
+      c[i + j] ^= a[i] & b[j];
+
+  for (int k = 14; k >= 8; k--)
+    {
+      c[k - 1] ^= c[k];
+      c[k - 2] ^= c[k];
+      c[k - 7] ^= c[k];
+      c[k - 8] ^= c[k];
+    }
+
+  for (int i = 0; i < 8; i++)
+    out[i] = c[i];
+}
+
+// every element of the slices equal to coef
+inline void broadcast (unsigned char coef, Slice *out)
+{
+  for (int i = 0; i < 8; i++)
+    out[i] = Slice {} - static_cast<uint64_t> ((coef >> i) & 1);
+}
+
+// Applies op (in, out) to slices of up to chunk_elements elements of every source at a time.
+// A partial last chunk goes through zero-padded copies, the lengths being public.
+template <int sources, class Op>
+void for_each_chunk (const Element *const *srcs, Element *dst, size_t len, Op op)
+{
+  Chunk in[sources];
+  Chunk out;
+  Element padded[chunk_elements];
+
+  for (size_t offset = 0; offset < len; offset += chunk_elements)
+    {
+      size_t size = std::min (chunk_elements, len - offset);
+      for (int s = 0; s < sources; s++)
+        {
+          unsigned char *planes[8];
+          for (int b = 0; b < 8; b++)
+            planes[b] = in[s].planes[b];
+
+          const Element *src = srcs[s] + offset;
+          if (size < chunk_elements)
+            {
+              std::fill (padded, padded + chunk_elements, zero_element ());
+              std::copy (src, src + size, padded);
+              src = padded;
+            }
+          to_bitplanes (src, planes, chunk_elements);
+        }
+
+      Slice a[sources][8];
+      Slice result[8];
+      for (size_t s = 0; s < slices_per_chunk; s++)
+        {
+          for (int i = 0; i < sources; i++)
+            for (int b = 0; b < 8; b++)
+              a[i][b] = in[i].slice (b, s);
+
+          op (a, result);
+          for (int b = 0; b < 8; b++)
+            out.set_slice (b, s, result[b]);
+        }
+
+      const unsigned char *planes[8];
+      for (int b = 0; b < 8; b++)
+        planes[b] = out.planes[b];
+
+      if (size < chunk_elements)
+        {
+          from_bitplanes (planes, padded, chunk_elements);
+          std::copy (padded, padded + size, dst + offset);
+        }
+      else
+        from_bitplanes (planes, dst + offset, chunk_elements);
+    }
+}
+} //namespace bitslice_impl
+
+// dst[i] = a[i] * b[i]
+inline void mul_region (const Element *a, const Element *b, Element *dst, size_t len)
+{
+  using namespace bitslice_impl;
+  const Element *srcs[2] = {a, b};
+  for_each_chunk<2> (srcs, dst, len, [] (const Slice (*in)[8], Slice *out)
+  {
+    mul (in[0], in[1], out);
+  });
+}
+
+// dst = coef * src, with a secret coef
+inline void mul_region (Element coef, const Element *src, Element *dst, size_t len)
+{
+  using namespace bitslice_impl;
+  Slice c[8];
+  broadcast (coef.additive_rep (), c);
+  for_each_chunk<1> (&src, dst, len, [&c] (const Slice (*in)[8], Slice *out)
+  {
+    mul (in[0], c, out);
+  });
+}
+
+// dst += coef * src, with a secret coef
+inline void mul_add_region (Element coef, const Element *src, Element *dst, size_t len)
+{
+  using namespace bitslice_impl;
+  Slice c[8];
+  broadcast (coef.additive_rep (), c);
+  const Element *srcs[2] = {src, dst};
+  for_each_chunk<2> (srcs, dst, len, [&c] (const Slice (*in)[8], Slice *out)
+  {
+    mul (in[0], c, out);
+    for (int b = 0; b < 8; b++)
+      out[b] ^= in[1][b];
+  });
+}
+
+// dst[i] = src[i]^-1, zero for zero, by the same addition chain as inv
+inline void inv_region (const Element *src, Element *dst, size_t len)
+{
+  using namespace bitslice_impl;
+  for_each_chunk<1> (&src, dst, len, [] (const Slice (*in)[8], Slice *out)
+  {
+    const Slice *a = in[0];
+    Slice power[8];
+    Slice square[8];
+    for (int b = 0; b < 8; b++)
+      power[b] = a[b];
+
+    for (int step = 0; step < 6; step++)
+      {
+        mul (power, power, square);
+        mul (square, a, power);
+      }
+    mul (power, power, out);
+  });
+}
+} //namespace ct
+
+// Element with the constant-time arithmetic of GF256::ct, for code that handles secrets
+// (Shamir shares, keys). Converts explicitly from and to Element.
+class ConstantTimeElement
+{
+  unsigned char m_additive_rep = 0;
+
+public:
+  constexpr ConstantTimeElement () {}
+  constexpr explicit ConstantTimeElement (Element element) : m_additive_rep (element.additive_rep ()) {}
+
+  constexpr Element element () const {return Element (m_additive_rep);}
+
+  constexpr ConstantTimeElement inv () const            {return ConstantTimeElement (ct::inv (element ()));}
+  constexpr ConstantTimeElement pow (int power) const   {return ConstantTimeElement (ct::pow (element (), power));}
+
+  constexpr ConstantTimeElement &operator += (ConstantTimeElement rhs) {return *this = *this + rhs;}
+  constexpr ConstantTimeElement &operator -= (ConstantTimeElement rhs) {return *this = *this - rhs;}
+  constexpr ConstantTimeElement &operator *= (ConstantTimeElement rhs) {return *this = *this * rhs;}
+  constexpr ConstantTimeElement &operator /= (ConstantTimeElement rhs) {return *this = *this / rhs;}
+
+  friend constexpr ConstantTimeElement operator + (ConstantTimeElement lhs, ConstantTimeElement rhs)
+  {
+    return ConstantTimeElement (lhs.element () + rhs.element ());
+  }
+
+  friend constexpr ConstantTimeElement operator - (ConstantTimeElement lhs, ConstantTimeElement rhs)
+  {
+    return lhs + rhs;
+  }
+
+  friend constexpr ConstantTimeElement operator * (ConstantTimeElement lhs, ConstantTimeElement rhs)
+  {
+    return ConstantTimeElement (ct::mul (lhs.element (), rhs.element ()));
+  }
+
+  // zero when rhs is zero
+  friend constexpr ConstantTimeElement operator / (ConstantTimeElement lhs, ConstantTimeElement rhs)
+  {
+    return ConstantTimeElement (ct::div (lhs.element (), rhs.element ()));
+  }
+
+  // not a constant-time comparison, compare secrets through element () with care
+  friend constexpr bool operator == (ConstantTimeElement lhs, ConstantTimeElement rhs)
+  {
+    return lhs.m_additive_rep == rhs.m_additive_rep;
+  }
+
+  friend constexpr bool operator != (ConstantTimeElement lhs, ConstantTimeElement rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_CONSTANT_TIME_HPP
@@ -0,0 +1,138 @@
+#ifndef GF256_FIXED_REED_SOLOMON_HPP
+#define GF256_FIXED_REED_SOLOMON_HPP
+
+#include "ReedSolomon.hpp"
+
+#include <array>
+#include <utility>
+
+namespace GF256
+{
+
+// ReedSolomon for a geometry known at compile time. The parity matrix and its nibble tables are constexpr,
+// computed from the tables in impl/representations.hpp, and the encoding loops over inputs and outputs are
+// unrolled by the compiler, so accumulators stay in registers and tables are read from fixed addresses.
+// Produces the same parity as ReedSolomon (K, M); decoding, which depends on the erasure pattern, is
+// delegated to one shared ReedSolomon (K, M).
+template <int K, int M>
+class FixedReedSolomon
+{
+  static_assert (K > 0 && M >= 0 && K + M <= 256, "GF256 has no room for such a code");
+
+public:
+  static constexpr int data_shards = K;
+  static constexpr int parity_shards = M;
+  static constexpr int total_shards = K + M;
+
+  using ParityMatrix = std::array<std::array<Element, K>, M>;
+
+  // same Cauchy rows as cauchy_matrix (M, K, K)
+  static constexpr ParityMatrix parity_matrix = []
+  {
+    ParityMatrix matrix {};
+    for (int i = 0; i < M; i++)
+      for (int j = 0; j < K; j++)
+        matrix[i][j] = (Element (static_cast<unsigned char> (K + i)) + Element (static_cast<unsigned char> (j))).inv ();
+    return matrix;
+  } ();
+
+  static constexpr std::array<NibbleTable, K * M> parity_tables = []
+  {
+    std::array<NibbleTable, K * M> tables {};
+    for (int i = 0; i < M; i++)
+      for (int j = 0; j < K; j++)
+        tables[i * K + j] = make_nibble_table (parity_matrix[i][j]);
+    return tables;
+  } ();
+
+  static constexpr Element coefficient (int parity, int data) {return parity_matrix[parity][data];}
+
+  // data: K pointers, parity: M pointers
+  static void encode (const Element *const *data, Element *const *parity, size_t len)
+  {
+    size_t done = 0;
+#ifdef __SSSE3__
+    done = encode_groups<0> (data, parity, len);
+#endif
+    using namespace bulk_impl;
+    for (size_t i = done; i < len; i++)
+      for (int o = 0; o < M; o++)
+        {
+          unsigned char acc = 0;
+          for (int j = 0; j < K; j++)
+            acc ^= mul_byte (parity_tables[o * K + j], bytes (data[j])[i]);
+          bytes (parity[o])[i] = acc;
+        }
+  }
+
+  // stripes stripes of K data and M parity pointers, stripe after stripe
+  static void encode_batch (const Element *const *data, Element *const *parity, int stripes, size_t len)
+  {
+    for (int s = 0; s < stripes; s++)
+      encode (data + s * K, parity + s * M, len);
+  }
+
+  static const ReedSolomon &codec ()
+  {
+    static const ReedSolomon instance (K, M);
+    return instance;
+  }
+
+  static bool reconstruct (Element *const *shards, const std::vector<bool> &present, size_t len)
+  {
+    return codec ().reconstruct (shards, present, len);
+  }
+
+private:
+#ifdef __SSSE3__
+  // Up to 8 outputs per pass over the data. With the tables at fixed addresses, 16-byte blocks leave
+  // enough registers for 8 accumulators, which measured faster than the 32-byte blocks of dot_product_multi.
+  template <int First>
+  static size_t encode_groups (const Element *const *data, Element *const *parity, size_t len)
+  {
+    if constexpr (First >= M)
+      return 0;
+    else
+      {
+        constexpr int outputs = std::min (8, M - First);
+        size_t done = encode_group<First, outputs> (data, parity, len, std::make_index_sequence<K> ());
+        if constexpr (First + outputs < M)
+          encode_groups<First + outputs> (data, parity, len);
+        return done;
+      }
+  }
+
+  template <int First, int Outputs, size_t... J>
+  static size_t encode_group (const Element *const *data, Element *const *parity, size_t len,
+                              std::index_sequence<J...>)
+  {
+    using namespace bulk_impl;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+      {
+        __m128i acc[Outputs] = {};
+        (accumulate<First, Outputs, J> (acc, bytes (data[J]) + i), ...);
+
+        for (int o = 0; o < Outputs; o++)
+          store (bytes (parity[First + o]) + i, acc[o]);
+      }
+    return i;
+  }
+
+  template <int First, int Outputs, size_t J>
+  static void accumulate (__m128i *acc, const unsigned char *src)
+  {
+    using namespace bulk_impl;
+    __m128i x = load (src);
+    for (int o = 0; o < Outputs; o++)
+      {
+        const NibbleTable &table = parity_tables[(First + o) * K + J];
+        acc[o] = _mm_xor_si128 (acc[o], mul_block (load (table.low), load (table.high), x));
+      }
+  }
+#endif
+};
+
+} //namespace GF256
+
+#endif // GF256_FIXED_REED_SOLOMON_HPP
@@ -4,9 +4,12 @@
 #include "impl/representations.hpp"
 
 #include <cstddef>
+#include <exception>
+#include <string>
 
 namespace GF256
 {
+void run_benchmark_suit ();
 
 class Element
 {
@@ -82,6 +85,8 @@ public:
   constexpr explicit Element (unsigned char additive_rep)
     : m_additive_rep (additive_rep) {}
 
+  constexpr unsigned char additive_rep () const {return m_additive_rep;}
+
 private:
 
   static constexpr Element from_mult_rep (int mult_rep)
@@ -0,0 +1,441 @@
+#ifndef GF256_JIT_ENCODER_HPP
+#define GF256_JIT_ENCODER_HPP
+
+#include "impl/bulk.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#if defined (__x86_64__) && defined (__linux__)
+#include <sys/mman.h>
+#define GF256_JIT_AVAILABLE 1
+#endif
+
+namespace GF256
+{
+
+#ifdef GF256_JIT_AVAILABLE
+namespace jit_impl
+{
+// Just enough of an x86-64 assembler for the SSSE3 dot-product kernel.
+class Assembler
+{
+  struct Fixup
+  {
+    size_t disp_pos;  // where the rel32 goes
+    size_t next_ip;   // end of the instruction it belongs to
+    int constant;     // index into m_constants
+  };
+
+  std::vector<uint8_t> m_code;
+  std::vector<NibbleTable> m_constants; // 16-byte constants, low and high halves addressed separately
+  std::vector<Fixup> m_fixups;
+
+public:
+  size_t size () const {return m_code.size ();}
+
+  void byte (uint8_t value) {m_code.push_back (value);}
+
+  void dword (uint32_t value)
+  {
+    for (int i = 0; i < 4; i++)
+      byte (static_cast<uint8_t> (value >> (8 * i)));
+  }
+
+  void bytes (std::initializer_list<uint8_t> values)
+  {
+    for (uint8_t value : values)
+      byte (value);
+  }
+
+  // SSE instruction: prefix [REX] opcode modrm, xmm registers 0..15
+  void sse_rr (uint8_t prefix, std::initializer_list<uint8_t> opcode, int reg, int rm)
+  {
+    byte (prefix);
+    rex (reg, rm);
+    bytes (opcode);
+    byte (static_cast<uint8_t> (0xc0 | ((reg & 7) << 3) | (rm & 7)));
+  }
+
+  // SSE instruction with the memory operand [rax + rcx]
+  void sse_rax_rcx (uint8_t prefix, std::initializer_list<uint8_t> opcode, int reg)
+  {
+    byte (prefix);
+    rex (reg, 0);
+    bytes (opcode);
+    byte (static_cast<uint8_t> (0x04 | ((reg & 7) << 3)));
+    byte (0x08);
+  }
+
+  // SSE instruction with the memory operand [rip + constant], constant is a 16-byte aligned half of a table
+  void sse_rip (uint8_t prefix, std::initializer_list<uint8_t> opcode, int reg, int constant)
+  {
+    byte (prefix);
+    rex (reg, 0);
+    bytes (opcode);
+    byte (static_cast<uint8_t> (0x05 | ((reg & 7) << 3)));
+    m_fixups.push_back ({m_code.size (), m_code.size () + 4, constant});
+    dword (0);
+  }
+
+  // VEX.256 instruction: ymm registers 0..15, vvvv is the extra source (or the destination of shifts)
+  void vex_rr (int pp, int map, uint8_t opcode, int reg, int vvvv, int rm)
+  {
+    vex (pp, map, reg, vvvv, rm);
+    byte (opcode);
+    byte (static_cast<uint8_t> (0xc0 | ((reg & 7) << 3) | (rm & 7)));
+  }
+
+  void vex_rax_rcx (int pp, int map, uint8_t opcode, int reg)
+  {
+    vex (pp, map, reg, 0, 0);
+    byte (opcode);
+    byte (static_cast<uint8_t> (0x04 | ((reg & 7) << 3)));
+    byte (0x08);
+  }
+
+  void vex_rip (int pp, int map, uint8_t opcode, int reg, int constant)
+  {
+    vex (pp, map, reg, 0, 0);
+    byte (opcode);
+    byte (static_cast<uint8_t> (0x05 | ((reg & 7) << 3)));
+    m_fixups.push_back ({m_code.size (), m_code.size () + 4, constant});
+    dword (0);
+  }
+
+  int add_constant (const NibbleTable &table)
+  {
+    m_constants.push_back (table);
+    return static_cast<int> (m_constants.size () - 1) * 2;
+  }
+
+  // Appends the constants after the code and resolves every rip-relative reference.
+  std::vector<uint8_t> finish ()
+  {
+    while (m_code.size () % 16)
+      byte (0xcc);
+
+    size_t constants_pos = m_code.size ();
+    for (const NibbleTable &table : m_constants)
+      {
+        m_code.insert (m_code.end (), table.low, table.low + 16);
+        m_code.insert (m_code.end (), table.high, table.high + 16);
+      }
+
+    for (const Fixup &fixup : m_fixups)
+      {
+        int32_t disp = static_cast<int32_t> (constants_pos + 16 * fixup.constant - fixup.next_ip);
+        memcpy (m_code.data () + fixup.disp_pos, &disp, 4);
+      }
+
+    return m_code;
+  }
+
+private:
+  void rex (int reg, int rm)
+  {
+    if (reg >= 8 || rm >= 8)
+      byte (static_cast<uint8_t> (0x40 | ((reg >> 3) << 2) | (rm >> 3)));
+  }
+
+  // three-byte VEX prefix with W = 0 and L = 1
+  void vex (int pp, int map, int reg, int vvvv, int rm)
+  {
+    byte (0xc4);
+    byte (static_cast<uint8_t> ((reg < 8 ? 0x80 : 0) | 0x40 | (rm < 8 ? 0x20 : 0) | map));
+    byte (static_cast<uint8_t> (((~vvvv & 15) << 3) | 0x04 | pp));
+  }
+};
+} //namespace jit_impl
+#endif
+
+enum class JitKernel
+{
+  none,  // nothing generated, run () is dot_product_multi
+  ssse3,
+  avx2
+};
+
+// Widest code the generator can emit for the running CPU, detected once.
+inline JitKernel best_jit_kernel ()
+{
+#ifdef GF256_JIT_AVAILABLE
+  static const JitKernel kernel = __builtin_cpu_supports ("avx2")    ? JitKernel::avx2
+                                  : __builtin_cpu_supports ("ssse3") ? JitKernel::ssse3
+                                                                     : JitKernel::none;
+  return kernel;
+#else
+  return JitKernel::none;
+#endif
+}
+
+inline bool jit_kernel_supported (JitKernel kernel)
+{
+  return kernel <= best_jit_kernel ();
+}
+
+// Dot-product kernel generated at run time for one fixed coefficient matrix (outputs x count, row-major).
+// The inner loop is fully unrolled over inputs and outputs, the nibble tables of the first coefficients stay
+// in otherwise unused registers and the rest are embedded next to the code and read rip-relative.
+// Zero coefficients vanish and ones become a plain XOR.
+// The code is best_jit_kernel () unless another kernel is forced, regardless of the flags the library was built
+// with. With JitKernel::none, more than 8 outputs, or when executable memory is refused, run () falls back to
+// dot_product_multi.
+class JitEncoder
+{
+  using KernelFn = void (*) (const Element *const *srcs, Element *const *dsts, size_t len);
+
+  int m_count = 0;
+  int m_outputs = 0;
+  std::vector<NibbleTable> m_tables;
+  void *m_code = nullptr;
+  size_t m_code_size = 0;
+  size_t m_block = 16;
+  KernelFn m_kernel = nullptr;
+  JitKernel m_isa = JitKernel::none;
+
+public:
+  // An unsupported kernel is a programmer error.
+  JitEncoder (const Element *coefs, int count, int outputs, JitKernel kernel = best_jit_kernel ())
+    : m_count (count), m_outputs (outputs),
+      m_tables (make_nibble_tables (coefs, static_cast<size_t> (count) * outputs))
+  {
+    if (!jit_kernel_supported (kernel))
+      std::terminate (); // the CPU lacks the instructions of this kernel
+
+#ifdef GF256_JIT_AVAILABLE
+    if (kernel != JitKernel::none && outputs > 0 && outputs <= 8)
+      compile (coefs, kernel == JitKernel::avx2);
+#endif
+  }
+
+  JitEncoder (const JitEncoder &) = delete;
+  JitEncoder &operator = (const JitEncoder &) = delete;
+
+  ~JitEncoder ()
+  {
+#ifdef GF256_JIT_AVAILABLE
+    if (m_code)
+      munmap (m_code, m_code_size);
+#endif
+  }
+
+  bool compiled () const {return m_kernel != nullptr;}
+  JitKernel kernel () const {return m_isa;} // JitKernel::none when run () falls back
+  size_t code_size () const {return m_code_size;}
+
+  // dsts[o] = sum over j of coefs[o * count + j] * srcs[j]
+  void run (const Element *const *srcs, Element *const *dsts, size_t len) const
+  {
+    if (!m_kernel)
+      {
+        dot_product_multi (m_tables.data (), srcs, m_count, dsts, m_outputs, len);
+        return;
+      }
+
+    size_t blocks_len = len - len % m_block;
+    m_kernel (srcs, dsts, blocks_len);
+    if (blocks_len == len)
+      return;
+
+    std::vector<const Element *> src_tails (m_count);
+    std::vector<Element *> dst_tails (m_outputs);
+    for (int j = 0; j < m_count; j++)
+      src_tails[j] = srcs[j] + blocks_len;
+    for (int o = 0; o < m_outputs; o++)
+      dst_tails[o] = dsts[o] + blocks_len;
+
+    dot_product_multi (m_tables.data (), src_tails.data (), m_count, dst_tails.data (), m_outputs, len - blocks_len);
+  }
+
+private:
+#ifdef GF256_JIT_AVAILABLE
+  void compile (const Element *coefs, bool avx2)
+  {
+    // SysV: rdi = srcs, rsi = dsts, rdx = len (multiple of the block size)
+    // xmm0..xmm(outputs - 1) accumulators, xmm8 source block, xmm9 low nibbles, xmm11 high nibbles,
+    // xmm10 product, xmm15 nibble mask, the remaining registers pinned tables.
+    // With AVX2 the same registers are used as ymm and the 16-byte tables are broadcast to both lanes.
+    const uint8_t p66 = 0x66;
+    const uint8_t pf3 = 0xf3;
+    const int vex_66 = 1;
+    const int vex_f3 = 2;
+    const int map_0f = 1;
+    const int map_0f38 = 2;
+    const int x_src = 8;
+    const int x_low = 9;
+    const int x_prod = 10;
+    const int x_high = 11;
+    const int x_mask = 15;
+
+    jit_impl::Assembler a;
+
+    auto load_constant = [&] (int reg, int constant)
+    {
+      if (avx2)
+        a.vex_rip (vex_66, map_0f38, 0x5a, reg, constant);          // vbroadcasti128 reg, [constant]
+      else
+        a.sse_rip (p66, {0x0f, 0x6f}, reg, constant);               // movdqa reg, [constant]
+    };
+
+    auto pxor = [&] (int reg, int rm)
+    {
+      if (avx2)
+        a.vex_rr (vex_66, map_0f, 0xef, reg, reg, rm);              // vpxor reg, reg, rm
+      else
+        a.sse_rr (p66, {0x0f, 0xef}, reg, rm);                      // pxor reg, rm
+    };
+
+    NibbleTable mask;
+    memset (&mask, 0x0f, sizeof (mask));
+    load_constant (x_mask, a.add_constant (mask));
+
+    // Registers no accumulator uses hold the tables of the first coefficients for the whole call.
+    std::vector<int> spare = {12, 13, 14};
+    for (int r = m_outputs; r < 8; r++)
+      spare.push_back (r);
+
+    std::vector<int> pinned (static_cast<size_t> (m_count) * m_outputs, -1);
+    std::vector<int> constants (pinned.size (), -1);
+    size_t next_spare = 0;
+    for (int j = 0; j < m_count; j++)
+      for (int o = 0; o < m_outputs; o++)
+        {
+          Element coef = coefs[o * m_count + j];
+          if (coef == zero_element () || coef == neutral_mult_element ())
+            continue;
+
+          int index = o * m_count + j;
+          constants[index] = a.add_constant (make_nibble_table (coef));
+          if (next_spare + 2 <= spare.size ())
+            {
+              pinned[index] = static_cast<int> (next_spare);
+              load_constant (spare[next_spare], constants[index]);
+              load_constant (spare[next_spare + 1], constants[index] + 1);
+              next_spare += 2;
+            }
+        }
+
+    a.bytes ({0x31, 0xc9});                                        // xor ecx, ecx
+    a.bytes ({0x48, 0x85, 0xd2});                                  // test rdx, rdx
+    a.bytes ({0x0f, 0x84});                                        // jz done
+    size_t jz_pos = a.size ();
+    a.dword (0);
+
+    size_t loop_pos = a.size ();
+    for (int o = 0; o < m_outputs; o++)
+      pxor (o, o);
+
+    for (int j = 0; j < m_count; j++)
+      {
+        bool used = false;
+        for (int o = 0; o < m_outputs; o++)
+          used = used || coefs[o * m_count + j] != zero_element ();
+        if (!used)
+          continue;
+
+        a.bytes ({0x48, 0x8b, 0x87});                              // mov rax, [rdi + 8 * j]
+        a.dword (static_cast<uint32_t> (8 * j));
+        if (avx2)
+          {
+            a.vex_rax_rcx (vex_f3, map_0f, 0x6f, x_src);           // vmovdqu ymm8, [rax + rcx]
+            a.vex_rr (vex_66, map_0f, 0xdb, x_low, x_src, x_mask); // vpand ymm9, ymm8, ymm15
+            a.vex_rr (vex_66, map_0f, 0x71, 2, x_high, x_src);     // vpsrlw ymm11, ymm8, 4
+            a.byte (4);
+            a.vex_rr (vex_66, map_0f, 0xdb, x_high, x_high, x_mask); // vpand ymm11, ymm11, ymm15
+          }
+        else
+          {
+            a.sse_rax_rcx (pf3, {0x0f, 0x6f}, x_src);              // movdqu xmm8, [rax + rcx]
+            a.sse_rr (p66, {0x0f, 0x6f}, x_low, x_src);            // movdqa xmm9, xmm8
+            a.sse_rr (p66, {0x0f, 0xdb}, x_low, x_mask);           // pand xmm9, xmm15
+            a.sse_rr (p66, {0x0f, 0x6f}, x_high, x_src);           // movdqa xmm11, xmm8
+            a.sse_rr (p66, {0x0f, 0x71}, 2, x_high);               // psrlw xmm11, 4
+            a.byte (4);
+            a.sse_rr (p66, {0x0f, 0xdb}, x_high, x_mask);          // pand xmm11, xmm15
+          }
+
+        for (int o = 0; o < m_outputs; o++)
+          {
+            int index = o * m_count + j;
+            Element coef = coefs[index];
+            if (coef == zero_element ())
+              continue;
+
+            if (coef == neutral_mult_element ())
+              {
+                pxor (o, x_src);
+                continue;
+              }
+
+            for (int half = 0; half < 2; half++)
+              {
+                int nibbles = half ? x_high : x_low;
+                int table = x_prod;
+                if (pinned[index] >= 0)
+                  table = spare[pinned[index] + half];
+                else
+                  load_constant (x_prod, constants[index] + half);
+
+                if (avx2)
+                  a.vex_rr (vex_66, map_0f38, 0x00, x_prod, table, nibbles); // vpshufb ymm10, table, nibbles
+                else
+                  {
+                    if (table != x_prod)
+                      a.sse_rr (p66, {0x0f, 0x6f}, x_prod, table); // movdqa xmm10, pin
+                    a.sse_rr (p66, {0x0f, 0x38, 0x00}, x_prod, nibbles); // pshufb xmm10, nibbles
+                  }
+                pxor (o, x_prod);
+              }
+          }
+      }
+
+    for (int o = 0; o < m_outputs; o++)
+      {
+        a.bytes ({0x48, 0x8b, 0x86});                              // mov rax, [rsi + 8 * o]
+        a.dword (static_cast<uint32_t> (8 * o));
+        if (avx2)
+          a.vex_rax_rcx (vex_f3, map_0f, 0x7f, o);                 // vmovdqu [rax + rcx], ymm_o
+        else
+          a.sse_rax_rcx (pf3, {0x0f, 0x7f}, o);                    // movdqu [rax + rcx], xmm_o
+      }
+
+    m_block = avx2 ? 32 : 16;
+    a.bytes ({0x48, 0x83, 0xc1, static_cast<uint8_t> (m_block)});  // add rcx, block
+    a.bytes ({0x48, 0x39, 0xd1});                                  // cmp rcx, rdx
+    a.bytes ({0x0f, 0x82});                                        // jb loop
+    a.dword (static_cast<uint32_t> (static_cast<int32_t> (loop_pos - (a.size () + 4))));
+
+    size_t done_pos = a.size ();
+    if (avx2)
+      a.bytes ({0xc5, 0xf8, 0x77});                                // vzeroupper
+    a.byte (0xc3);                                                 // ret
+
+    std::vector<uint8_t> code = a.finish ();
+    int32_t jz_disp = static_cast<int32_t> (done_pos - (jz_pos + 4));
+    memcpy (code.data () + jz_pos, &jz_disp, 4);
+
+    void *memory = mmap (nullptr, code.size (), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+      return;
+
+    memcpy (memory, code.data (), code.size ());
+    if (mprotect (memory, code.size (), PROT_READ | PROT_EXEC) != 0)
+      {
+        munmap (memory, code.size ());
+        return;
+      }
+
+    m_code = memory;
+    m_code_size = code.size ();
+    m_kernel = reinterpret_cast<KernelFn> (memory);
+    m_isa = avx2 ? JitKernel::avx2 : JitKernel::ssse3;
+  }
+#endif
+};
+
+} //namespace GF256
+
+#endif // GF256_JIT_ENCODER_HPP
@@ -0,0 +1,203 @@
+#ifndef GF256_LRC_HPP
+#define GF256_LRC_HPP
+
+#include "Matrix.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace GF256
+{
+
+// Locally repairable code in the style of Azure LRC(k, l, r).
+// Shard layout: [0, k) data, [k, k + l) local parities, [k + l, k + l + r) global parities.
+// Data shard i belongs to local group i * l / k; the local parity of a group is the sum of its data shards,
+// so a single lost data or local parity shard is rebuilt from its group alone.
+// Global parities are Cauchy rows over all data shards and take part in the global decode.
+class LRC
+{
+  int m_data_shards = 0;
+  int m_local_groups = 0;
+  int m_global_parities = 0;
+  Matrix m_generator;      // total_shards () x data_shards
+  Tables m_parity_tables;  // parity rows of m_generator, expanded once
+
+public:
+  LRC (int data_shards, int local_groups, int global_parities)
+    : m_data_shards (data_shards), m_local_groups (local_groups), m_global_parities (global_parities)
+  {
+    if (data_shards <= 0 || local_groups <= 0 || local_groups > data_shards || global_parities < 0
+        || data_shards + global_parities > 256)
+      std::terminate (); // GF256 has no room for such a code
+
+    m_generator = Matrix (total_shards (), data_shards);
+    for (int i = 0; i < data_shards; i++)
+      {
+        m_generator (i, i) = neutral_mult_element ();
+        m_generator (data_shards + group (i), i) = neutral_mult_element ();
+      }
+
+    Matrix global = cauchy_matrix (global_parities, data_shards, data_shards);
+    for (int i = 0; i < global_parities; i++)
+      std::copy (global.row (i), global.row (i) + data_shards, m_generator.row (data_shards + local_groups + i));
+
+    m_parity_tables = expand_coefficients (m_generator.row (data_shards), local_groups + global_parities, data_shards);
+  }
+
+  int data_shards () const     {return m_data_shards;}
+  int local_groups () const    {return m_local_groups;}
+  int global_parities () const {return m_global_parities;}
+  int total_shards () const    {return m_data_shards + m_local_groups + m_global_parities;}
+
+  const Matrix &generator_matrix () const {return m_generator;}
+
+  // Local group of a data or local parity shard, -1 for global parities.
+  int group (int shard) const
+  {
+    if (shard < m_data_shards)
+      return shard * m_local_groups / m_data_shards;
+
+    if (shard < m_data_shards + m_local_groups)
+      return shard - m_data_shards;
+
+    return -1;
+  }
+
+  // Data shards of a local group.
+  std::vector<int> group_members (int group_index) const
+  {
+    std::vector<int> members;
+    for (int i = 0; i < m_data_shards; i++)
+      if (group (i) == group_index)
+        members.push_back (i);
+    return members;
+  }
+
+  // Shards read to rebuild a single lost shard.
+  std::vector<int> repair_sources (int shard) const
+  {
+    int g = group (shard);
+    if (g < 0)
+      {
+        std::vector<int> data (m_data_shards);
+        for (int i = 0; i < m_data_shards; i++)
+          data[i] = i;
+        return data;
+      }
+
+    std::vector<int> sources;
+    for (int member : group_members (g))
+      if (member != shard)
+        sources.push_back (member);
+
+    if (shard != m_data_shards + g)
+      sources.push_back (m_data_shards + g);
+
+    return sources;
+  }
+
+  // parity: local_groups () local parities followed by global_parities () global ones
+  void encode (const Element *const *data, Element *const *parity, size_t len) const
+  {
+    dot_product_multi (m_parity_tables, data, parity, len);
+  }
+
+  // Rebuilds a single lost shard from repair_sources (shard) only.
+  void repair (int shard, Element *const *shards, size_t len) const
+  {
+    std::vector<int> sources = repair_sources (shard);
+    if (group (shard) < 0)
+      {
+        dot_product (m_parity_tables.row (shard - m_data_shards), shards, m_data_shards, shards[shard], len);
+        return;
+      }
+
+    memcpy (shards[shard], shards[sources[0]], len);
+    for (size_t i = 1; i < sources.size (); i++)
+      add_region (shards[sources[i]], shards[shard], len);
+  }
+
+  // Rebuilds every shard that is not marked present. Groups with a single loss are repaired locally,
+  // anything left falls back to a global decode. Returns false if the stripe is lost.
+  bool reconstruct (Element *const *shards, const std::vector<bool> &present, size_t len) const
+  {
+    std::vector<bool> available = present;
+
+    for (int g = 0; g < m_local_groups; g++)
+      {
+        std::vector<int> members = group_members (g);
+        members.push_back (m_data_shards + g);
+
+        int lost = -1;
+        int lost_count = 0;
+        for (int member : members)
+          if (!available[member])
+            {
+              lost = member;
+              lost_count++;
+            }
+
+        if (lost_count != 1)
+          continue;
+
+        repair (lost, shards, len);
+        available[lost] = true;
+      }
+
+    bool data_complete = true;
+    for (int i = 0; i < m_data_shards; i++)
+      data_complete = data_complete && available[i];
+
+    if (!data_complete && !global_decode (shards, available, len))
+      return false;
+
+    for (int i = m_data_shards; i < total_shards (); i++)
+      if (!available[i])
+        dot_product (m_parity_tables.row (i - m_data_shards), shards, m_data_shards, shards[i], len);
+
+    return true;
+  }
+
+private:
+  bool global_decode (Element *const *shards, std::vector<bool> &available, size_t len) const
+  {
+    std::vector<int> candidates;
+    for (int i = 0; i < total_shards (); i++)
+      if (available[i])
+        candidates.push_back (i);
+
+    std::vector<int> picked = m_generator.select_rows (candidates).independent_rows ();
+    if (static_cast<int> (picked.size ()) < m_data_shards)
+      return false;
+
+    std::vector<int> rows (m_data_shards);
+    std::vector<const Element *> sources (m_data_shards);
+    for (int i = 0; i < m_data_shards; i++)
+      {
+        rows[i] = candidates[picked[i]];
+        sources[i] = shards[rows[i]];
+      }
+
+    auto inverse = m_generator.select_rows (rows).inverse ();
+    if (!inverse)
+      return false;
+
+    // the rows of the lost data shards, expanded once and computed in a single pass over the sources
+    std::vector<int> lost;
+    std::vector<Element *> targets;
+    for (int i = 0; i < m_data_shards; i++)
+      if (!available[i])
+        {
+          lost.push_back (i);
+          targets.push_back (shards[i]);
+          available[i] = true;
+        }
+
+    dot_product_multi (expand_coefficients (inverse->select_rows (lost)), sources.data (), targets.data (), len);
+    return true;
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_LRC_HPP
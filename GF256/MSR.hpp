@@ -0,0 +1,185 @@
+#ifndef GF256_MSR_HPP
+#define GF256_MSR_HPP
+
+#include "Matrix.hpp"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace GF256
+{
+
+// Product-matrix minimum-storage regenerating code (Rashmi, Shah, Kumar) with d = 2k - 2.
+// The message is B = k * (k - 1) symbols of len bytes, arranged as two symmetric alpha x alpha matrices
+// S1, S2 (alpha = k - 1) stacked into M = [S1; S2]. Node i stores alpha symbols psi_i^T * M with
+// psi_i = (1, x_i, ..., x_i^(d - 1)) = [phi_i, lambda_i * phi_i].
+// Any k nodes rebuild the message; a failed node is regenerated from a single computed symbol
+// of each of d helpers instead of k whole shards.
+class ProductMatrixMSR
+{
+  int m_nodes = 0;
+  int m_data_nodes = 0;
+  int m_alpha = 0;
+  Matrix m_psi;        // nodes x d
+  Matrix m_generator;  // (nodes * alpha) x message_symbols, stored symbol = row * message
+
+  // alpha x d repair matrices, expanded, by failed node followed by the helper nodes
+  mutable std::mutex m_repairs_mutex;
+  mutable std::map<std::vector<int>, Tables> m_repairs;
+
+public:
+  ProductMatrixMSR (int nodes, int data_nodes)
+    : m_nodes (nodes), m_data_nodes (data_nodes), m_alpha (data_nodes - 1)
+  {
+    if (data_nodes < 2 || nodes < helpers () + 1)
+      std::terminate (); // product-matrix MSR needs n >= d + 1 = 2k - 1
+
+    m_psi = Matrix (nodes, helpers ());
+
+    // distinct x_i make any d rows of Psi and any alpha rows of Phi invertible,
+    // distinct lambda_i = x_i^alpha make the message recoverable from any k nodes
+    std::vector<bool> lambda_used (256, false);
+    int node = 0;
+    for (int x = 1; x < 256 && node < nodes; x++)
+      {
+        Element xi (static_cast<unsigned char> (x));
+        Element lambda = xi.pow (m_alpha);
+        if (lambda_used[lambda.additive_rep ()])
+          continue;
+
+        lambda_used[lambda.additive_rep ()] = true;
+        for (int c = 0; c < helpers (); c++)
+          m_psi (node, c) = xi.pow (c);
+        node++;
+      }
+
+    if (node < nodes)
+      std::terminate (); // not enough distinct lambdas in GF256
+
+    m_generator = Matrix (nodes * m_alpha, message_symbols ());
+    for (int i = 0; i < nodes; i++)
+      for (int c = 0; c < m_alpha; c++)
+        for (int r = 0; r < helpers (); r++)
+          m_generator (i * m_alpha + c, message_index (r, c)) += m_psi (i, r);
+  }
+
+  int nodes () const           {return m_nodes;}
+  int data_nodes () const      {return m_data_nodes;}
+  int helpers () const         {return 2 * m_data_nodes - 2;}
+  int alpha () const           {return m_alpha;}
+  int message_symbols () const {return m_data_nodes * m_alpha;}
+
+  // message: message_symbols () symbols of len bytes each, shards: nodes () buffers of alpha () symbols
+  void encode (const Element *message, Element *const *shards, size_t len) const
+  {
+    std::vector<const Element *> symbols (message_symbols ());
+    for (int s = 0; s < message_symbols (); s++)
+      symbols[s] = message + s * len;
+
+    for (int i = 0; i < m_nodes; i++)
+      for (int c = 0; c < m_alpha; c++)
+        dot_product (m_generator.row (i * m_alpha + c), symbols.data (), message_symbols (), shards[i] + c * len, len);
+  }
+
+  // Symbol a helper sends for the repair of the failed node: psi_helper^T * M * phi_failed.
+  void helper_fragment (int failed, const Element *helper_shard, Element *fragment, size_t len) const
+  {
+    std::vector<const Element *> symbols (m_alpha);
+    for (int c = 0; c < m_alpha; c++)
+      symbols[c] = helper_shard + c * len;
+
+    dot_product (m_psi.row (failed), symbols.data (), m_alpha, fragment, len);
+  }
+
+  // Repair matrix of the failed node from the given helpers, computed once per failed node and helper set.
+  // Returns nullptr when the helpers are not helpers () distinct nodes.
+  const Tables *repair_tables (int failed, const std::vector<int> &helper_nodes) const
+  {
+    if (static_cast<int> (helper_nodes.size ()) != helpers ())
+      return nullptr;
+
+    std::vector<int> key (1, failed);
+    key.insert (key.end (), helper_nodes.begin (), helper_nodes.end ());
+
+    std::lock_guard<std::mutex> lock (m_repairs_mutex);
+    auto it = m_repairs.find (key);
+    if (it != m_repairs.end ())
+      return &it->second;
+
+    auto inverse = m_psi.select_rows (helper_nodes).inverse ();
+    if (!inverse)
+      return nullptr;
+
+    // fragments = Psi_helpers * M * phi_f, so inverse * fragments = [S1 * phi_f; S2 * phi_f] and,
+    // S1 and S2 being symmetric, symbol c of the failed node is (S1 * phi_f)_c + lambda_f * (S2 * phi_f)_c
+    Element lambda = m_psi (failed, m_alpha);
+    Matrix repair (m_alpha, helpers ());
+    for (int c = 0; c < m_alpha; c++)
+      for (int j = 0; j < helpers (); j++)
+        repair (c, j) = (*inverse) (c, j) + lambda * (*inverse) (m_alpha + c, j);
+
+    return &m_repairs.emplace (std::move (key), expand_coefficients (repair)).first->second;
+  }
+
+  // Rebuilds the shard of the failed node from the fragments of helpers () distinct helper nodes,
+  // reading every fragment once.
+  bool regenerate (int failed, const std::vector<int> &helper_nodes, const Element *const *fragments,
+                   Element *shard, size_t len) const
+  {
+    const Tables *tables = repair_tables (failed, helper_nodes);
+    if (!tables)
+      return false;
+
+    std::vector<Element *> symbols (m_alpha);
+    for (int c = 0; c < m_alpha; c++)
+      symbols[c] = shard + c * len;
+
+    dot_product_multi (*tables, fragments, symbols.data (), len);
+    return true;
+  }
+
+  // Rebuilds the message from the shards of data_nodes () distinct nodes.
+  bool reconstruct (const std::vector<int> &source_nodes, const Element *const *shards, Element *message, size_t len) const
+  {
+    if (static_cast<int> (source_nodes.size ()) != m_data_nodes)
+      return false;
+
+    std::vector<int> rows;
+    std::vector<const Element *> symbols;
+    for (int i = 0; i < m_data_nodes; i++)
+      for (int c = 0; c < m_alpha; c++)
+        {
+          rows.push_back (source_nodes[i] * m_alpha + c);
+          symbols.push_back (shards[i] + c * len);
+        }
+
+    auto inverse = m_generator.select_rows (rows).inverse ();
+    if (!inverse)
+      return false;
+
+    for (int s = 0; s < message_symbols (); s++)
+      dot_product (inverse->row (s), symbols.data (), message_symbols (), message + s * len, len);
+
+    return true;
+  }
+
+private:
+  // Message symbol stored at M[row][col]; entries mirrored by symmetry share a symbol.
+  int message_index (int row, int col) const
+  {
+    int half = m_alpha * (m_alpha + 1) / 2;
+    int offset = row < m_alpha ? 0 : half;
+    int a = row % m_alpha;
+    int b = col;
+    if (a > b)
+      std::swap (a, b);
+
+    // upper triangle, row by row
+    return offset + a * m_alpha - a * (a - 1) / 2 + (b - a);
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_MSR_HPP
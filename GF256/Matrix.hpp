@@ -0,0 +1,210 @@
+#ifndef GF256_MATRIX_HPP
+#define GF256_MATRIX_HPP
+
+#include "GF256.hpp"
+#include "impl/bulk.hpp"
+#include "impl/gemm.hpp"
+#include "impl/greased.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace GF256
+{
+
+// Dense row-major matrix over GF256.
+// Row operations of the solver run through the bulk kernels, so a row is a plain Element buffer.
+// Products with at least greased_rows rows and inverses of that size use the tables of greased.hpp.
+class Matrix
+{
+  int m_rows = 0;
+  int m_cols = 0;
+  std::vector<Element> m_elements;
+
+public:
+  static const int greased_rows = 128;
+
+  Matrix () {}
+
+  Matrix (int rows, int cols)
+    : m_rows (rows), m_cols (cols), m_elements (static_cast<size_t> (rows) * cols) {}
+
+  static Matrix identity (int size)
+  {
+    Matrix result (size, size);
+    for (int i = 0; i < size; i++)
+      result (i, i) = neutral_mult_element ();
+    return result;
+  }
+
+  int rows () const {return m_rows;}
+  int cols () const {return m_cols;}
+
+  Element &operator () (int row, int col)             {return m_elements[static_cast<size_t> (row) * m_cols + col];}
+  const Element &operator () (int row, int col) const {return m_elements[static_cast<size_t> (row) * m_cols + col];}
+
+  Element *row (int row)             {return m_elements.data () + static_cast<size_t> (row) * m_cols;}
+  const Element *row (int row) const {return m_elements.data () + static_cast<size_t> (row) * m_cols;}
+
+  Matrix select_rows (const std::vector<int> &rows) const
+  {
+    Matrix result (static_cast<int> (rows.size ()), m_cols);
+    for (int i = 0; i < result.rows (); i++)
+      std::copy (row (rows[i]), row (rows[i]) + m_cols, result.row (i));
+    return result;
+  }
+
+  // Gauss-Jordan elimination. Returns nothing for a singular or non-square matrix.
+  // allow_greased = false forces the plain elimination at any size.
+  std::optional<Matrix> inverse (bool allow_greased = true) const
+  {
+    if (m_rows != m_cols)
+      return std::nullopt;
+
+    int n = m_rows;
+    if (allow_greased && n >= greased_rows)
+      {
+        Matrix augmented (n, 2 * n);
+        for (int r = 0; r < n; r++)
+          {
+            std::copy (row (r), row (r) + n, augmented.row (r));
+            augmented (r, n + r) = neutral_mult_element ();
+          }
+
+        if (!greased_eliminate (augmented.row (0), n, 2 * n, 2 * n))
+          return std::nullopt;
+
+        Matrix result (n, n);
+        for (int r = 0; r < n; r++)
+          std::copy (augmented.row (r) + n, augmented.row (r) + 2 * n, result.row (r));
+        return result;
+      }
+
+    Matrix work = *this;
+    Matrix result = identity (n);
+
+    for (int col = 0; col < n; col++)
+      {
+        int pivot = col;
+        while (pivot < n && work (pivot, col) == zero_element ())
+          pivot++;
+
+        if (pivot == n)
+          return std::nullopt;
+
+        if (pivot != col)
+          {
+            std::swap_ranges (work.row (pivot), work.row (pivot) + n, work.row (col));
+            std::swap_ranges (result.row (pivot), result.row (pivot) + n, result.row (col));
+          }
+
+        Element scale = work (col, col).inv ();
+        mul_region (scale, work.row (col), work.row (col), n);
+        mul_region (scale, result.row (col), result.row (col), n);
+
+        for (int r = 0; r < n; r++)
+          {
+            Element factor = work (r, col);
+            if (r == col || factor == zero_element ())
+              continue;
+
+            mul_add_region (factor, work.row (col), work.row (r), n);
+            mul_add_region (factor, result.row (col), result.row (r), n);
+          }
+      }
+
+    return result;
+  }
+
+  // Greedily picks rows (in order) that are linearly independent of the rows picked before them.
+  // The result has rank () entries.
+  std::vector<int> independent_rows () const
+  {
+    std::vector<int> picked;
+    std::vector<int> pivot_cols;
+    Matrix basis (0, m_cols);
+
+    for (int r = 0; r < m_rows; r++)
+      {
+        std::vector<Element> reduced (row (r), row (r) + m_cols);
+        for (int b = 0; b < static_cast<int> (picked.size ()); b++)
+          mul_add_region (reduced[pivot_cols[b]], basis.row (b), reduced.data (), m_cols);
+
+        int pivot = 0;
+        while (pivot < m_cols && reduced[pivot] == zero_element ())
+          pivot++;
+
+        if (pivot == m_cols)
+          continue;
+
+        mul_region (reduced[pivot].inv (), reduced.data (), reduced.data (), m_cols);
+        for (int b = 0; b < static_cast<int> (picked.size ()); b++)
+          mul_add_region (basis (b, pivot), reduced.data (), basis.row (b), m_cols);
+
+        basis.m_elements.insert (basis.m_elements.end (), reduced.begin (), reduced.end ());
+        basis.m_rows++;
+        picked.push_back (r);
+        pivot_cols.push_back (pivot);
+      }
+
+    return picked;
+  }
+
+  int rank () const
+  {
+    return static_cast<int> (independent_rows ().size ());
+  }
+
+  friend Matrix operator * (const Matrix &lhs, const Matrix &rhs)
+  {
+    if (lhs.m_cols != rhs.m_rows)
+      std::terminate (); // dimensions mismatch
+
+    Matrix result (lhs.m_rows, rhs.m_cols);
+    if (lhs.m_rows >= greased_rows)
+      greased_multiply (lhs.m_rows, lhs.m_cols, rhs.m_cols, lhs.row (0), lhs.m_cols, rhs.row (0), rhs.m_cols,
+                        result.row (0), result.m_cols);
+    else
+      gemm (lhs.m_rows, lhs.m_cols, rhs.m_cols, lhs.row (0), lhs.m_cols, rhs.row (0), rhs.m_cols,
+            result.row (0), result.m_cols);
+
+    return result;
+  }
+
+  friend bool operator == (const Matrix &lhs, const Matrix &rhs)
+  {
+    return lhs.m_rows == rhs.m_rows && lhs.m_cols == rhs.m_cols && lhs.m_elements == rhs.m_elements;
+  }
+
+  friend bool operator != (const Matrix &lhs, const Matrix &rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+// NibbleTables of every coefficient, for the bulk kernels taking tables
+inline Tables expand_coefficients (const Matrix &matrix)
+{
+  return Tables (matrix.row (0), matrix.rows (), matrix.cols ());
+}
+
+// Cauchy matrix 1 / (x_i + y_j) with x_i = first_x + i and y_j = j.
+// Every square submatrix is invertible as long as first_x >= cols and first_x + rows <= 256.
+inline Matrix cauchy_matrix (int rows, int cols, int first_x)
+{
+  Matrix result (rows, cols);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++)
+      {
+        Element x (static_cast<unsigned char> (first_x + i));
+        Element y (static_cast<unsigned char> (j));
+        result (i, j) = (x + y).inv ();
+      }
+  return result;
+}
+
+} //namespace GF256
+
+#endif // GF256_MATRIX_HPP
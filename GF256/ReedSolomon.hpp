@@ -0,0 +1,259 @@
+#ifndef GF256_REED_SOLOMON_HPP
+#define GF256_REED_SOLOMON_HPP
+
+#include "Matrix.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace GF256
+{
+
+// Systematic Reed-Solomon erasure codec with data_shards data and parity_shards parity shards.
+// Shard i < data_shards is data, the rest is parity. Parity rows form a Cauchy matrix,
+// so any data_shards surviving shards reconstruct the stripe.
+class ReedSolomon
+{
+public:
+  struct Decoder
+  {
+    std::vector<int> rows;  // shards the stripe is decoded from
+    Matrix inverse;         // data = inverse * (shards listed in rows)
+    Tables inverse_tables;  // inverse, expanded once
+    Matrix parity;          // parity = parity * (shards listed in rows)
+    Tables parity_tables;   // parity, expanded once
+  };
+
+  struct VerifyResult
+  {
+    bool ok = true;
+    int shard = -1;   // first parity shard found inconsistent
+    size_t block = 0; // index of the block it was found in
+  };
+
+private:
+  static void prefetch (const Element *ptr, size_t len)
+  {
+    for (size_t offset = 0; offset < len; offset += 64)
+      __builtin_prefetch (ptr + offset);
+  }
+
+  int m_data_shards = 0;
+  int m_parity_shards = 0;
+  Matrix m_encode_matrix;
+  Tables m_parity_tables; // parity rows of m_encode_matrix, expanded once
+
+  mutable std::mutex m_decoders_mutex;
+  mutable std::map<std::vector<bool>, Decoder> m_decoders;
+
+public:
+  ReedSolomon (int data_shards, int parity_shards)
+    : m_data_shards (data_shards), m_parity_shards (parity_shards)
+  {
+    if (data_shards <= 0 || parity_shards < 0 || data_shards + parity_shards > 256)
+      std::terminate (); // GF256 has no room for such a code
+
+    int n = data_shards + parity_shards;
+    Matrix parity = cauchy_matrix (parity_shards, data_shards, data_shards);
+
+    m_encode_matrix = Matrix (n, data_shards);
+    for (int i = 0; i < data_shards; i++)
+      m_encode_matrix (i, i) = neutral_mult_element ();
+
+    for (int i = 0; i < parity_shards; i++)
+      std::copy (parity.row (i), parity.row (i) + data_shards, m_encode_matrix.row (data_shards + i));
+
+    m_parity_tables = expand_coefficients (m_encode_matrix.row (data_shards), parity_shards, data_shards);
+  }
+
+  int data_shards () const   {return m_data_shards;}
+  int parity_shards () const {return m_parity_shards;}
+  int total_shards () const  {return m_data_shards + m_parity_shards;}
+
+  // (data_shards + parity_shards) x data_shards, identity on top
+  const Matrix &encode_matrix () const {return m_encode_matrix;}
+
+  // parity rows of encode_matrix () as NibbleTables, in the gftbls layout of ISA-L
+  const Tables &parity_tables () const {return m_parity_tables;}
+
+  Element coefficient (int parity, int data) const
+  {
+    return m_encode_matrix (m_data_shards + parity, data);
+  }
+
+  void encode (const Element *const *data, Element *const *parity, size_t len) const
+  {
+    dot_product_multi (m_parity_tables, data, parity, len);
+  }
+
+  // Encodes many small stripes of the same geometry in one call: data holds stripes * data_shards pointers,
+  // parity stripes * parity_shards, stripe after stripe. The next stripe is prefetched while one is encoded.
+  void encode_batch (const Element *const *data, Element *const *parity, int stripes, size_t len) const
+  {
+    for (int s = 0; s < stripes; s++)
+      {
+        if (s + 1 < stripes)
+          for (int i = 0; i < m_data_shards; i++)
+            prefetch (data[(s + 1) * m_data_shards + i], len);
+
+        dot_product_multi (m_parity_tables, data + s * m_data_shards, parity + s * m_parity_shards, len);
+      }
+  }
+
+  // encode that also returns the CRC32C of every data and parity shard, computed in the same pass
+  void encode (const Element *const *data, Element *const *parity, size_t len,
+               uint32_t *data_crcs, uint32_t *parity_crcs) const
+  {
+    dot_product_multi_crc (m_parity_tables.row (0), data, m_data_shards, parity, m_parity_shards, len,
+                           data_crcs, parity_crcs);
+  }
+
+  // Scrub: recomputes parity block by block and compares it with the stored one in the same pass,
+  // nothing is written. Stops at the first inconsistent block.
+  VerifyResult verify (const Element *const *data, const Element *const *parity, size_t len,
+                       size_t block_size = 4096) const
+  {
+    if (block_size == 0)
+      std::terminate (); // the scrub would never advance
+
+    VerifyResult result;
+    std::vector<const Element *> sources (m_data_shards);
+
+    for (size_t offset = 0, block = 0; offset < len; offset += block_size, block++)
+      {
+        size_t size = std::min (block_size, len - offset);
+        for (int i = 0; i < m_data_shards; i++)
+          sources[i] = data[i] + offset;
+
+        for (int j = 0; j < m_parity_shards; j++)
+          if (!dot_product_equals (m_parity_tables.row (j), sources.data (), m_data_shards,
+                                   parity[j] + offset, size))
+            {
+              result.ok = false;
+              result.shard = m_data_shards + j;
+              result.block = block;
+              return result;
+            }
+      }
+
+    return result;
+  }
+
+  // Brings every parity shard up to date after bytes [offset, offset + len) of data shard shard_index
+  // changed from old_data to new_data: parity_j += c_j * (new - old) over the changed range only.
+  void update_parity (int shard_index, size_t offset, const Element *old_data, const Element *new_data,
+                      size_t len, Element *const *parity) const
+  {
+    if (shard_index < 0 || shard_index >= m_data_shards)
+      std::terminate (); // not a data shard
+
+    const size_t chunk = 4096;
+    Element delta[chunk];
+    std::vector<NibbleTable> tables (m_parity_shards);
+    std::vector<Element *> targets (m_parity_shards);
+    for (int j = 0; j < m_parity_shards; j++)
+      tables[j] = m_parity_tables (j, shard_index);
+
+    for (size_t done = 0; done < len; done += chunk)
+      {
+        size_t size = std::min (chunk, len - done);
+        std::copy (new_data + done, new_data + done + size, delta);
+        add_region (old_data + done, delta, size);
+
+        for (int j = 0; j < m_parity_shards; j++)
+          targets[j] = parity[j] + offset + done;
+
+        mul_add_multi (tables.data (), delta, targets.data (), m_parity_shards, size);
+      }
+  }
+
+  // Decoding matrix for the given set of surviving shards, computed once per pattern.
+  // Returns nullptr when fewer than data_shards shards survive.
+  const Decoder *decoder (const std::vector<bool> &present) const
+  {
+    if (static_cast<int> (present.size ()) != total_shards ())
+      std::terminate (); // one flag per shard
+
+    std::lock_guard<std::mutex> lock (m_decoders_mutex);
+
+    auto it = m_decoders.find (present);
+    if (it != m_decoders.end ())
+      return &it->second;
+
+    Decoder decoder;
+    for (int i = 0; i < total_shards () && static_cast<int> (decoder.rows.size ()) < m_data_shards; i++)
+      if (present[i])
+        decoder.rows.push_back (i);
+
+    if (static_cast<int> (decoder.rows.size ()) < m_data_shards)
+      return nullptr;
+
+    auto inverse = m_encode_matrix.select_rows (decoder.rows).inverse ();
+    if (!inverse)
+      return nullptr;
+
+    decoder.inverse = std::move (*inverse);
+    decoder.inverse_tables = expand_coefficients (decoder.inverse);
+
+    Matrix parity_rows (m_parity_shards, m_data_shards);
+    std::copy (m_encode_matrix.row (m_data_shards), m_encode_matrix.row (m_data_shards) + m_parity_shards * m_data_shards,
+               parity_rows.row (0));
+    decoder.parity = parity_rows * decoder.inverse;
+    decoder.parity_tables = expand_coefficients (decoder.parity);
+    return &m_decoders.emplace (present, std::move (decoder)).first->second;
+  }
+
+  // Rebuilds every shard that is not marked present. Returns false if the stripe is lost.
+  bool reconstruct (Element *const *shards, const std::vector<bool> &present, size_t len) const
+  {
+    const Decoder *dec = decoder (present);
+    if (!dec)
+      return false;
+
+    std::vector<const Element *> sources (m_data_shards);
+    for (int i = 0; i < m_data_shards; i++)
+      sources[i] = shards[dec->rows[i]];
+
+    for (int i = 0; i < m_data_shards; i++)
+      if (!present[i])
+        dot_product (dec->inverse_tables.row (i), sources.data (), m_data_shards, shards[i], len);
+
+    for (int i = m_data_shards; i < total_shards (); i++)
+      if (!present[i])
+        dot_product (m_parity_tables.row (i - m_data_shards), shards, m_data_shards, shards[i], len);
+
+    return true;
+  }
+
+  // Degraded read: bytes [offset, offset + len) of the missing shard, computed from the same window
+  // of data_shards surviving shards with a single row of the cached decoding matrices.
+  bool reconstruct_range (const Element *const *shards, const std::vector<bool> &present, int missing,
+                          size_t offset, size_t len, Element *out) const
+  {
+    if (missing < 0 || missing >= total_shards ())
+      std::terminate (); // no such shard
+
+    const Decoder *dec = decoder (present);
+    if (!dec)
+      return false;
+
+    std::vector<const Element *> sources (m_data_shards);
+    for (int i = 0; i < m_data_shards; i++)
+      sources[i] = shards[dec->rows[i]] + offset;
+
+    if (missing < m_data_shards)
+      {
+        dot_product (dec->inverse_tables.row (missing), sources.data (), m_data_shards, out, len);
+        return true;
+      }
+
+    dot_product (dec->parity_tables.row (missing - m_data_shards), sources.data (), m_data_shards, out, len);
+    return true;
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_REED_SOLOMON_HPP
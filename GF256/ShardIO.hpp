@@ -0,0 +1,442 @@
+#ifndef GF256_SHARD_IO_HPP
+#define GF256_SHARD_IO_HPP
+
+#include "GF256.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace GF256
+{
+
+// O_DIRECT wants buffers, lengths and offsets aligned to the logical block size; 4096 covers every device.
+inline constexpr size_t direct_io_alignment = 4096;
+
+// Zero-initialized Element buffer aligned for O_DIRECT.
+class AlignedBuffer
+{
+  Element *m_data = nullptr;
+  size_t m_size = 0;
+
+public:
+  AlignedBuffer () {}
+
+  explicit AlignedBuffer (size_t size) : m_size (size)
+  {
+    void *ptr = nullptr;
+    size_t rounded = (size + direct_io_alignment - 1) / direct_io_alignment * direct_io_alignment;
+    if (posix_memalign (&ptr, direct_io_alignment, rounded ? rounded : direct_io_alignment) != 0)
+      std::terminate (); // out of memory
+
+    memset (ptr, 0, rounded);
+    m_data = static_cast<Element *> (ptr);
+  }
+
+  AlignedBuffer (AlignedBuffer &&other) : m_data (other.m_data), m_size (other.m_size)
+  {
+    other.m_data = nullptr;
+    other.m_size = 0;
+  }
+
+  AlignedBuffer &operator = (AlignedBuffer &&other)
+  {
+    std::swap (m_data, other.m_data);
+    std::swap (m_size, other.m_size);
+    return *this;
+  }
+
+  ~AlignedBuffer ()
+  {
+    free (m_data);
+  }
+
+  Element *data () const {return m_data;}
+  size_t size () const   {return m_size;}
+};
+
+// Opens a shard file with O_DIRECT, falling back to buffered I/O where the file system refuses it (tmpfs).
+inline int open_shard_file (const std::string &path, bool write)
+{
+  int flags = write ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+  int fd = open (path.c_str (), flags | O_DIRECT, 0644);
+  if (fd < 0 && errno == EINVAL)
+    fd = open (path.c_str (), flags, 0644);
+  return fd;
+}
+
+// Batched asynchronous shard reads and writes.
+// submit () queues a batch (typically the k + m shards of a stripe) and returns at once, wait () blocks
+// until that batch has completed, so the caller encodes the next stripe while the previous one is written.
+// io_uring is used when the kernel allows it, otherwise a pool of threads runs pread/pwrite.
+// submit () and wait () must be called from one thread.
+class ShardIO
+{
+public:
+  enum class Backend
+  {
+    automatic,
+    io_uring,
+    thread_pool
+  };
+
+  struct Request
+  {
+    int fd = -1;
+    void *buffer = nullptr;
+    size_t len = 0;
+    uint64_t offset = 0;
+    bool write = true;
+  };
+
+private:
+  struct Batch
+  {
+    int remaining = 0;
+    bool ok = true;
+  };
+
+  struct Job
+  {
+    Request request;
+    uint64_t batch;
+  };
+
+  // An io_uring request in flight: short transfers are resubmitted for the rest, and requests longer
+  // than max_sqe_len go out in several SQEs one after the other.
+  struct Transfer
+  {
+    Request request;
+    uint64_t batch = 0;
+    size_t done = 0;
+  };
+
+  static constexpr size_t max_sqe_len = size_t (1) << 30; // fits the 32-bit sqe->len, keeps O_DIRECT alignment
+
+  Backend m_backend = Backend::thread_pool;
+  uint64_t m_next_batch = 0;
+
+  std::mutex m_mutex;
+  std::condition_variable m_done_cv;
+  std::map<uint64_t, Batch> m_batches;
+
+  // io_uring
+  int m_ring_fd = -1;
+  unsigned m_sq_entries = 0;
+  unsigned m_in_flight = 0;
+  uint64_t m_next_transfer = 0;
+  std::map<uint64_t, Transfer> m_transfers; // by user_data
+  void *m_sq_ring = MAP_FAILED;
+  void *m_cq_ring = MAP_FAILED;
+  size_t m_sq_ring_size = 0;
+  size_t m_cq_ring_size = 0;
+  io_uring_sqe *m_sqes = nullptr;
+  size_t m_sqes_size = 0;
+  unsigned *m_sq_tail = nullptr;
+  unsigned *m_sq_mask = nullptr;
+  unsigned *m_sq_array = nullptr;
+  unsigned *m_cq_head = nullptr;
+  unsigned *m_cq_tail = nullptr;
+  unsigned *m_cq_mask = nullptr;
+  io_uring_cqe *m_cqes = nullptr;
+
+  // thread pool
+  std::condition_variable m_jobs_cv;
+  std::deque<Job> m_jobs;
+  std::vector<std::thread> m_workers;
+  bool m_stopping = false;
+
+public:
+  explicit ShardIO (unsigned queue_depth = 64, Backend backend = Backend::automatic, int pool_threads = 4)
+  {
+    if (backend != Backend::thread_pool && setup_ring (queue_depth))
+      {
+        m_backend = Backend::io_uring;
+        return;
+      }
+
+    m_backend = Backend::thread_pool;
+    for (int i = 0; i < pool_threads; i++)
+      m_workers.emplace_back ([this] {worker_loop ();});
+  }
+
+  ShardIO (const ShardIO &) = delete;
+  ShardIO &operator = (const ShardIO &) = delete;
+
+  ~ShardIO ()
+  {
+    if (m_backend == Backend::io_uring)
+      {
+        while (m_in_flight > 0)
+          reap (true);
+
+        munmap (m_sqes, m_sqes_size);
+        if (m_cq_ring != m_sq_ring)
+          munmap (m_cq_ring, m_cq_ring_size);
+        munmap (m_sq_ring, m_sq_ring_size);
+        close (m_ring_fd);
+        return;
+      }
+
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_stopping = true;
+    }
+    m_jobs_cv.notify_all ();
+    for (auto &worker : m_workers)
+      worker.join ();
+  }
+
+  Backend backend () const {return m_backend;}
+
+  uint64_t submit (const std::vector<Request> &requests)
+  {
+    uint64_t batch = m_next_batch++;
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_batches[batch].remaining = static_cast<int> (requests.size ());
+    }
+
+    if (m_backend == Backend::thread_pool)
+      {
+        {
+          std::lock_guard<std::mutex> lock (m_mutex);
+          for (const Request &request : requests)
+            m_jobs.push_back ({request, batch});
+        }
+        m_jobs_cv.notify_all ();
+        return batch;
+      }
+
+    unsigned queued = 0;
+    for (const Request &request : requests)
+      {
+        if (m_in_flight == m_sq_entries)
+          {
+            enter (queued, 0);
+            queued = 0;
+            while (m_in_flight == m_sq_entries)
+              reap (true);
+          }
+
+        uint64_t id = m_next_transfer++;
+        m_transfers[id] = {request, batch, 0};
+        push_sqe (id);
+        queued++;
+      }
+
+    enter (queued, 0);
+    return batch;
+  }
+
+  // True if every request of the batch transferred its whole length.
+  bool wait (uint64_t batch)
+  {
+    if (m_backend == Backend::io_uring)
+      {
+        while (m_batches.at (batch).remaining > 0)
+          reap (true);
+
+        bool ok = m_batches[batch].ok;
+        m_batches.erase (batch);
+        return ok;
+      }
+
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_done_cv.wait (lock, [&] {return m_batches.at (batch).remaining == 0;});
+    bool ok = m_batches[batch].ok;
+    m_batches.erase (batch);
+    return ok;
+  }
+
+private:
+  bool setup_ring (unsigned queue_depth)
+  {
+    io_uring_params params;
+    memset (&params, 0, sizeof (params));
+    int fd = static_cast<int> (syscall (__NR_io_uring_setup, queue_depth, &params));
+    if (fd < 0)
+      return false;
+
+    m_ring_fd = fd;
+    m_sq_entries = params.sq_entries;
+    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+      m_sq_ring_size = m_cq_ring_size = std::max (m_sq_ring_size, m_cq_ring_size);
+
+    m_sq_ring = mmap (nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (m_sq_ring == MAP_FAILED)
+      {
+        close (fd);
+        return false;
+      }
+
+    m_cq_ring = m_sq_ring;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+      m_cq_ring = mmap (nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+    m_sqes_size = params.sq_entries * sizeof (io_uring_sqe);
+    void *sqes = mmap (nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (m_cq_ring == MAP_FAILED || sqes == MAP_FAILED)
+      {
+        if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+          munmap (m_cq_ring, m_cq_ring_size);
+        munmap (m_sq_ring, m_sq_ring_size);
+        close (fd);
+        return false;
+      }
+
+    unsigned char *sq = static_cast<unsigned char *> (m_sq_ring);
+    unsigned char *cq = static_cast<unsigned char *> (m_cq_ring);
+    m_sqes = static_cast<io_uring_sqe *> (sqes);
+    m_sq_tail = reinterpret_cast<unsigned *> (sq + params.sq_off.tail);
+    m_sq_mask = reinterpret_cast<unsigned *> (sq + params.sq_off.ring_mask);
+    m_sq_array = reinterpret_cast<unsigned *> (sq + params.sq_off.array);
+    m_cq_head = reinterpret_cast<unsigned *> (cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned *> (cq + params.cq_off.tail);
+    m_cq_mask = reinterpret_cast<unsigned *> (cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe *> (cq + params.cq_off.cqes);
+    return true;
+  }
+
+  // next chunk of the transfer
+  void push_sqe (uint64_t id)
+  {
+    const Transfer &transfer = m_transfers.at (id);
+    const Request &request = transfer.request;
+    unsigned tail = *m_sq_tail;
+    unsigned index = tail & *m_sq_mask;
+    io_uring_sqe *sqe = &m_sqes[index];
+    memset (sqe, 0, sizeof (*sqe));
+    sqe->opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = request.fd;
+    sqe->addr = reinterpret_cast<uint64_t> (static_cast<unsigned char *> (request.buffer) + transfer.done);
+    sqe->len = static_cast<uint32_t> (std::min (request.len - transfer.done, max_sqe_len));
+    sqe->off = request.offset + transfer.done;
+    sqe->user_data = id;
+    m_sq_array[index] = index;
+    __atomic_store_n (m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    m_in_flight++;
+  }
+
+  void enter (unsigned to_submit, unsigned min_complete)
+  {
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    while (to_submit > 0 || min_complete > 0)
+      {
+        long submitted = syscall (__NR_io_uring_enter, m_ring_fd, to_submit, min_complete, flags, nullptr, 0);
+        if (submitted < 0)
+          {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+              continue;
+            std::terminate (); // the ring is unusable
+          }
+
+        to_submit -= static_cast<unsigned> (submitted);
+        min_complete = 0;
+        flags = 0;
+      }
+  }
+
+  void reap (bool block)
+  {
+    unsigned head = *m_cq_head;
+    if (block && head == __atomic_load_n (m_cq_tail, __ATOMIC_ACQUIRE))
+      enter (0, 1);
+
+    std::vector<uint64_t> resubmit;
+    unsigned tail = __atomic_load_n (m_cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++)
+      {
+        const io_uring_cqe &cqe = m_cqes[head & *m_cq_mask];
+        m_in_flight--;
+
+        // the same error handling as transfer (): retry interrupted requests, fail on errors and end of file
+        auto it = m_transfers.find (cqe.user_data);
+        Transfer &transfer = it->second;
+        bool failed = (cqe.res == 0 && transfer.done < transfer.request.len)
+                      || (cqe.res < 0 && cqe.res != -EINTR && cqe.res != -EAGAIN);
+        if (cqe.res > 0)
+          transfer.done += static_cast<size_t> (cqe.res);
+        if (!failed && transfer.done < transfer.request.len)
+          {
+            resubmit.push_back (it->first);
+            continue;
+          }
+
+        Batch &batch = m_batches.at (transfer.batch);
+        batch.ok = batch.ok && !failed;
+        batch.remaining--;
+        m_transfers.erase (it);
+      }
+
+    __atomic_store_n (m_cq_head, head, __ATOMIC_RELEASE);
+
+    // each completion freed the ring slot its resubmission takes
+    for (uint64_t id : resubmit)
+      push_sqe (id);
+    enter (static_cast<unsigned> (resubmit.size ()), 0);
+  }
+
+  void worker_loop ()
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (true)
+      {
+        m_jobs_cv.wait (lock, [this] {return m_stopping || !m_jobs.empty ();});
+        if (m_jobs.empty ())
+          return;
+
+        Job job = m_jobs.front ();
+        m_jobs.pop_front ();
+        lock.unlock ();
+
+        bool ok = transfer (job.request);
+
+        lock.lock ();
+        Batch &batch = m_batches.at (job.batch);
+        batch.ok = batch.ok && ok;
+        if (--batch.remaining == 0)
+          m_done_cv.notify_all ();
+      }
+  }
+
+  static bool transfer (const Request &request)
+  {
+    unsigned char *buffer = static_cast<unsigned char *> (request.buffer);
+    size_t done = 0;
+    while (done < request.len)
+      {
+        ssize_t result = request.write
+                         ? pwrite (request.fd, buffer + done, request.len - done, static_cast<off_t> (request.offset + done))
+                         : pread (request.fd, buffer + done, request.len - done, static_cast<off_t> (request.offset + done));
+        if (result < 0 && errno == EINTR)
+          continue;
+        if (result <= 0)
+          return false;
+        done += static_cast<size_t> (result);
+      }
+    return true;
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_SHARD_IO_HPP
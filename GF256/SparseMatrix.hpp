@@ -0,0 +1,411 @@
+#ifndef GF256_SPARSE_MATRIX_HPP
+#define GF256_SPARSE_MATRIX_HPP
+
+#include "Matrix.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace GF256
+{
+
+// Sparse matrix over GF256 in compressed sparse row form: the nonzeros of row r are at
+// [row_starts[r], row_starts[r + 1]) of the column and value arrays, by increasing column.
+// transpose () of a matrix is its compressed sparse column form. Storage is about 5 bytes per nonzero,
+// instead of a byte per entry for Matrix.
+class SparseMatrix
+{
+  int m_rows = 0;
+  int m_cols = 0;
+  std::vector<int> m_row_starts;
+  std::vector<int> m_col_indices;
+  std::vector<Element> m_values;
+
+public:
+  struct Entry
+  {
+    int row;
+    int col;
+    Element value;
+  };
+
+  SparseMatrix () : m_row_starts (1) {}
+
+  SparseMatrix (int rows, int cols) : m_rows (rows), m_cols (cols), m_row_starts (rows + 1) {}
+
+  // Entries in any order. Entries at the same position are summed and zeros are dropped.
+  SparseMatrix (int rows, int cols, std::vector<Entry> entries)
+    : m_rows (rows), m_cols (cols), m_row_starts (rows + 1)
+  {
+    for (const Entry &entry : entries)
+      if (entry.row < 0 || entry.row >= rows || entry.col < 0 || entry.col >= cols)
+        std::terminate (); // entry out of the matrix
+
+    std::sort (entries.begin (), entries.end (), [] (const Entry &lhs, const Entry &rhs)
+    {
+      return lhs.row != rhs.row ? lhs.row < rhs.row : lhs.col < rhs.col;
+    });
+
+    for (size_t e = 0; e < entries.size ();)
+      {
+        const Entry &entry = entries[e];
+        Element value = zero_element ();
+        for (; e < entries.size () && entries[e].row == entry.row && entries[e].col == entry.col; e++)
+          value += entries[e].value;
+
+        if (value == zero_element ())
+          continue;
+
+        m_col_indices.push_back (entry.col);
+        m_values.push_back (value);
+        m_row_starts[entry.row + 1]++;
+      }
+
+    for (int r = 0; r < rows; r++)
+      m_row_starts[r + 1] += m_row_starts[r];
+  }
+
+  static SparseMatrix from_dense (const Matrix &matrix)
+  {
+    SparseMatrix result (matrix.rows (), matrix.cols ());
+    for (int r = 0; r < matrix.rows (); r++)
+      {
+        for (int c = 0; c < matrix.cols (); c++)
+          if (matrix (r, c) != zero_element ())
+            {
+              result.m_col_indices.push_back (c);
+              result.m_values.push_back (matrix (r, c));
+            }
+        result.m_row_starts[r + 1] = static_cast<int> (result.m_values.size ());
+      }
+    return result;
+  }
+
+  Matrix to_dense () const
+  {
+    Matrix result (m_rows, m_cols);
+    for (int r = 0; r < m_rows; r++)
+      for (int e = m_row_starts[r]; e < m_row_starts[r + 1]; e++)
+        result (r, m_col_indices[e]) = m_values[e];
+    return result;
+  }
+
+  int rows () const      {return m_rows;}
+  int cols () const      {return m_cols;}
+  size_t nonzeros () const {return m_values.size ();}
+
+  // columns and values of the nonzeros of a row
+  std::span<const int> row_cols (int row) const
+  {
+    return {m_col_indices.data () + m_row_starts[row], m_col_indices.data () + m_row_starts[row + 1]};
+  }
+
+  std::span<const Element> row_values (int row) const
+  {
+    return {m_values.data () + m_row_starts[row], m_values.data () + m_row_starts[row + 1]};
+  }
+
+  Element operator () (int row, int col) const
+  {
+    std::span<const int> cols = row_cols (row);
+    auto it = std::lower_bound (cols.begin (), cols.end (), col);
+    return it != cols.end () && *it == col ? row_values (row)[it - cols.begin ()] : zero_element ();
+  }
+
+  SparseMatrix transpose () const
+  {
+    SparseMatrix result (m_cols, m_rows);
+    for (int col : m_col_indices)
+      result.m_row_starts[col + 1]++;
+    for (int c = 0; c < m_cols; c++)
+      result.m_row_starts[c + 1] += result.m_row_starts[c];
+
+    result.m_col_indices.resize (m_values.size ());
+    result.m_values.resize (m_values.size ());
+    std::vector<int> next (result.m_row_starts.begin (), result.m_row_starts.end () - 1);
+    for (int r = 0; r < m_rows; r++)
+      for (int e = m_row_starts[r]; e < m_row_starts[r + 1]; e++)
+        {
+          int slot = next[m_col_indices[e]]++;
+          result.m_col_indices[slot] = r;
+          result.m_values[slot] = m_values[e];
+        }
+    return result;
+  }
+
+  // y = A * x, x of cols () Elements and y of rows ()
+  void multiply (const Element *x, Element *y) const
+  {
+    for (int r = 0; r < m_rows; r++)
+      {
+        Element sum = zero_element ();
+        for (int e = m_row_starts[r]; e < m_row_starts[r + 1]; e++)
+          sum += m_values[e] * x[m_col_indices[e]];
+        y[r] = sum;
+      }
+  }
+
+  // dsts[r] = sum of A (r, c) * srcs[c] over the nonzeros of row r, payloads of len Elements.
+  // Every output row is one dot_product over the payloads its nonzeros select.
+  void multiply (const Element *const *srcs, Element *const *dsts, size_t len) const
+  {
+    std::vector<const Element *> row_srcs;
+    for (int r = 0; r < m_rows; r++)
+      {
+        row_srcs.clear ();
+        for (int col : row_cols (r))
+          row_srcs.push_back (srcs[col]);
+        dot_product (row_values (r).data (), row_srcs.data (), static_cast<int> (row_srcs.size ()), dsts[r], len);
+      }
+  }
+
+  friend bool operator == (const SparseMatrix &lhs, const SparseMatrix &rhs)
+  {
+    return lhs.m_rows == rhs.m_rows && lhs.m_cols == rhs.m_cols && lhs.m_row_starts == rhs.m_row_starts
+           && lhs.m_col_indices == rhs.m_col_indices && lhs.m_values == rhs.m_values;
+  }
+
+  friend bool operator != (const SparseMatrix &lhs, const SparseMatrix &rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+// Solves A * X = B for the cols () payloads X, given the rows () payloads of B, all of len Elements, as an
+// RLNC or LDPC decoder does with the coefficient rows it received. Structured Gaussian elimination: the pivot
+// is picked by the Markowitz criterion, the nonzero minimizing (row count - 1) * (column count - 1), which
+// keeps fill-in low, and singleton rows and columns cost no fill at all. Only the rows touched by a pivot
+// are updated, and their payloads with mul_add_region. Once the nonzeros left exceed dense_density of the
+// remaining submatrix, fill-in has won and that submatrix is solved densely, by Matrix::inverse and gemm.
+// Extra rows are allowed and left unchecked. Returns false when A has rank below cols (); the solutions
+// are then unspecified.
+inline bool sparse_solve (const SparseMatrix &a, const Element *const *payloads, Element *const *solutions, size_t len,
+                          double dense_density = 0.1)
+{
+  using Row = std::vector<std::pair<int, Element>>;
+  auto find = [] (Row &row, int col)
+  {
+    return std::lower_bound (row.begin (), row.end (), col, [] (const auto &entry, int c) {return entry.first < c;});
+  };
+
+  const int rows = a.rows ();
+  const int cols = a.cols ();
+
+  std::vector<Row> work (rows);
+  std::vector<int> col_counts (cols);
+  std::vector<std::vector<int>> col_rows (cols); // rows that had a nonzero in the column, some stale
+  for (int r = 0; r < rows; r++)
+    {
+      std::span<const int> row_cols = a.row_cols (r);
+      std::span<const Element> row_values = a.row_values (r);
+      for (size_t e = 0; e < row_cols.size (); e++)
+        {
+          work[r].emplace_back (row_cols[e], row_values[e]);
+          col_counts[row_cols[e]]++;
+          col_rows[row_cols[e]].push_back (r);
+        }
+    }
+
+  std::vector<Element> buffers (static_cast<size_t> (rows) * len);
+  for (int r = 0; r < rows; r++)
+    std::copy (payloads[r], payloads[r] + len, buffers.data () + r * len);
+  auto payload = [&] (int r) {return buffers.data () + r * len;};
+
+  std::vector<bool> active (rows, true);
+  std::vector<bool> col_done (cols, false);
+  int active_rows = rows;
+  size_t active_nonzeros = a.nonzeros ();
+  std::vector<std::pair<int, int>> pivots; // (row, col) in elimination order
+  Row merged;
+  for (int step = 0; step < cols; step++)
+    {
+      if (active_nonzeros > dense_density * active_rows * (cols - step))
+        {
+          std::vector<int> dense_rows;
+          std::vector<int> dense_cols;
+          std::vector<int> col_positions (cols, -1);
+          for (int r = 0; r < rows; r++)
+            if (active[r] && !work[r].empty ())
+              dense_rows.push_back (r);
+          for (int c = 0; c < cols; c++)
+            if (!col_done[c])
+              {
+                col_positions[c] = static_cast<int> (dense_cols.size ());
+                dense_cols.push_back (c);
+              }
+
+          Matrix remaining (static_cast<int> (dense_rows.size ()), static_cast<int> (dense_cols.size ()));
+          for (int i = 0; i < remaining.rows (); i++)
+            for (const auto &[col, value] : work[dense_rows[i]])
+              remaining (i, col_positions[col]) = value;
+
+          // with extra rows, a square system is picked out of them first
+          const int size = remaining.cols ();
+          if (remaining.rows () > size)
+            {
+              std::vector<int> picked = remaining.independent_rows ();
+              if (static_cast<int> (picked.size ()) < size)
+                return false;
+
+              remaining = remaining.select_rows (picked);
+              for (int i = 0; i < size; i++)
+                dense_rows[i] = dense_rows[picked[i]];
+            }
+
+          std::optional<Matrix> inverse = remaining.inverse ();
+          if (!inverse)
+            return false;
+
+          std::vector<const Element *> srcs;
+          std::vector<Element *> dsts;
+          for (int i = 0; i < size; i++)
+            {
+              srcs.push_back (payload (dense_rows[i]));
+              dsts.push_back (solutions[dense_cols[i]]);
+            }
+          gemm (size, size, len, inverse->row (0), size, srcs.data (), dsts.data ());
+          break;
+        }
+
+      // A singleton column is a pivot without fill. Otherwise the Markowitz search is limited, as usual, to
+      // the few sparsest rows, so a step costs O(rows + cols) instead of a pass over every nonzero.
+      int pivot_row = -1;
+      int pivot_col = -1;
+      for (int c = 0; c < cols && pivot_row < 0; c++)
+        if (!col_done[c] && col_counts[c] == 1)
+          for (int r : col_rows[c])
+            if (active[r] && find (work[r], c) != work[r].end () && find (work[r], c)->first == c)
+              {
+                pivot_row = r;
+                pivot_col = c;
+                break;
+              }
+
+      if (pivot_row < 0)
+        {
+          const int search_rows = 4;
+          int sparsest[search_rows];
+          int found = 0;
+          for (int r = 0; r < rows; r++)
+            {
+              if (!active[r] || work[r].empty ())
+                continue;
+
+              int slot = std::min (found, search_rows - 1);
+              if (found == search_rows && work[r].size () >= work[sparsest[slot]].size ())
+                continue;
+              for (; slot > 0 && work[r].size () < work[sparsest[slot - 1]].size (); slot--)
+                sparsest[slot] = sparsest[slot - 1];
+              sparsest[slot] = r;
+              found = std::min (found + 1, search_rows);
+            }
+
+          long best = -1;
+          for (int i = 0; i < found; i++)
+            {
+              int r = sparsest[i];
+              long row_cost = static_cast<long> (work[r].size ()) - 1;
+              for (const auto &[col, value] : work[r])
+                {
+                  long cost = row_cost * (col_counts[col] - 1);
+                  if (best < 0 || cost < best)
+                    {
+                      best = cost;
+                      pivot_row = r;
+                      pivot_col = col;
+                    }
+                }
+            }
+        }
+
+      if (pivot_row < 0)
+        return false;
+
+      // normalize the pivot row
+      Row &pivot = work[pivot_row];
+      Element scale = find (pivot, pivot_col)->second.inv ();
+      for (auto &entry : pivot)
+        entry.second *= scale;
+      mul_region (scale, payload (pivot_row), payload (pivot_row), len);
+
+      active[pivot_row] = false;
+      active_rows--;
+      active_nonzeros -= pivot.size ();
+      for (const auto &entry : pivot)
+        col_counts[entry.first]--;
+
+      // clear the pivot column from the other active rows
+      for (int r : col_rows[pivot_col])
+        {
+          if (!active[r])
+            continue;
+
+          Row &row = work[r];
+          auto it = find (row, pivot_col);
+          if (it == row.end () || it->first != pivot_col)
+            continue;
+
+          Element factor = it->second;
+          merged.clear ();
+          size_t i = 0;
+          size_t j = 0;
+          while (i < row.size () || j < pivot.size ())
+            {
+              if (j == pivot.size () || (i < row.size () && row[i].first < pivot[j].first))
+                merged.push_back (row[i++]);
+              else if (i == row.size () || pivot[j].first < row[i].first)
+                {
+                  // fill-in
+                  int col = pivot[j].first;
+                  merged.emplace_back (col, factor * pivot[j++].second);
+                  col_counts[col]++;
+                  col_rows[col].push_back (r);
+                }
+              else
+                {
+                  Element sum = row[i].second + factor * pivot[j].second;
+                  if (sum != zero_element ())
+                    merged.emplace_back (row[i].first, sum);
+                  else
+                    col_counts[row[i].first]--;
+                  i++;
+                  j++;
+                }
+            }
+          active_nonzeros += merged.size ();
+          active_nonzeros -= row.size ();
+          row.swap (merged);
+          mul_add_region (factor, payload (pivot_row), payload (r), len);
+        }
+
+      col_rows[pivot_col].clear ();
+      col_rows[pivot_col].shrink_to_fit ();
+      col_done[pivot_col] = true;
+      pivots.emplace_back (pivot_row, pivot_col);
+    }
+
+  // a pivot row only holds columns pivoted after it, so back substitution runs in reverse
+  std::vector<Element> coefs;
+  std::vector<const Element *> srcs;
+  for (auto p = pivots.rbegin (); p != pivots.rend (); ++p)
+    {
+      coefs.assign (1, neutral_mult_element ());
+      srcs.assign (1, payload (p->first));
+      for (const auto &[col, value] : work[p->first])
+        if (col != p->second)
+          {
+            coefs.push_back (value);
+            srcs.push_back (solutions[col]);
+          }
+      dot_product (coefs.data (), srcs.data (), static_cast<int> (srcs.size ()), solutions[p->second], len);
+    }
+
+  return true;
+}
+
+} //namespace GF256
+
+#endif // GF256_SPARSE_MATRIX_HPP
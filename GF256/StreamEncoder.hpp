@@ -0,0 +1,165 @@
+#ifndef GF256_STREAM_ENCODER_HPP
+#define GF256_STREAM_ENCODER_HPP
+
+#include "ReedSolomon.hpp"
+#include "impl/spsc_queue.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace GF256
+{
+
+// Encodes a stream of unknown length with a fixed amount of memory.
+// The caller's thread fills stripes from write (), an encoder thread computes parity and a writer thread
+// hands finished stripes to the callback. The stages pass stripe slots through lock-free SPSC queues and
+// the slots come back to the caller once the callback returns, so at most ring_size stripes are in flight.
+class StreamEncoder
+{
+public:
+  struct Stripe
+  {
+    uint64_t index = 0;
+    size_t data_len = 0;           // stream bytes in the stripe, the rest of the data shards is zero padding
+    size_t shard_len = 0;
+    std::vector<Element *> shards; // data_shards () + parity_shards () shards of shard_len bytes
+  };
+
+  using Callback = std::function<void (const Stripe &)>;
+
+private:
+  const ReedSolomon &m_codec;
+  size_t m_shard_len = 0;
+  Callback m_callback;
+
+  std::vector<std::vector<Element>> m_buffers;
+  std::vector<Stripe> m_stripes;
+  SpscQueue<int> m_free;
+  SpscQueue<int> m_to_encode;
+  SpscQueue<int> m_to_write;
+
+  std::thread m_encoder;
+  std::thread m_writer;
+
+  int m_current = -1;
+  uint64_t m_next_index = 0;
+  uint64_t m_bytes_written = 0;
+  bool m_finished = false;
+
+public:
+  // ring_size > 0 stripe slots of codec.total_shards () * shard_len bytes
+  StreamEncoder (const ReedSolomon &codec, size_t shard_len, int ring_size, Callback callback)
+    : m_codec (codec), m_shard_len (shard_len), m_callback (std::move (callback)),
+      m_buffers (checked_ring_size (ring_size), std::vector<Element> (codec.total_shards () * shard_len)),
+      m_stripes (ring_size),
+      m_free (ring_size), m_to_encode (ring_size + 1), m_to_write (ring_size + 1)
+  {
+    for (int slot = 0; slot < ring_size; slot++)
+      {
+        Stripe &stripe = m_stripes[slot];
+        stripe.shard_len = shard_len;
+        for (int i = 0; i < codec.total_shards (); i++)
+          stripe.shards.push_back (m_buffers[slot].data () + i * shard_len);
+
+        m_free.push (slot);
+      }
+
+    m_encoder = std::thread ([this] {encode_loop ();});
+    m_writer = std::thread ([this] {write_loop ();});
+  }
+
+  StreamEncoder (const StreamEncoder &) = delete;
+  StreamEncoder &operator = (const StreamEncoder &) = delete;
+
+  ~StreamEncoder ()
+  {
+    finish ();
+  }
+
+  size_t stripe_data_len () const {return m_codec.data_shards () * m_shard_len;}
+  uint64_t bytes_written () const {return m_bytes_written;}
+
+  // Blocks only while all ring slots are in flight.
+  void write (const Element *data, size_t len)
+  {
+    while (len > 0)
+      {
+        if (m_current < 0)
+          {
+            m_current = m_free.pop ();
+            m_stripes[m_current].index = m_next_index++;
+            m_stripes[m_current].data_len = 0;
+          }
+
+        Stripe &stripe = m_stripes[m_current];
+        size_t size = std::min (len, stripe_data_len () - stripe.data_len);
+        std::copy (data, data + size, m_buffers[m_current].data () + stripe.data_len);
+        stripe.data_len += size;
+        data += size;
+        len -= size;
+        m_bytes_written += size;
+
+        if (stripe.data_len == stripe_data_len ())
+          {
+            m_to_encode.push (m_current);
+            m_current = -1;
+          }
+      }
+  }
+
+  // Pads and emits the last partial stripe, then waits until the callback has seen every stripe.
+  void finish ()
+  {
+    if (m_finished)
+      return;
+
+    if (m_current >= 0)
+      {
+        Stripe &stripe = m_stripes[m_current];
+        std::fill (m_buffers[m_current].begin () + stripe.data_len,
+                   m_buffers[m_current].begin () + stripe_data_len (), zero_element ());
+        m_to_encode.push (m_current);
+        m_current = -1;
+      }
+
+    m_to_encode.push (-1);
+    m_encoder.join ();
+    m_writer.join ();
+    m_finished = true;
+  }
+
+private:
+  static int checked_ring_size (int ring_size)
+  {
+    if (ring_size <= 0)
+      std::terminate (); // write () would wait forever for a free slot
+    return ring_size;
+  }
+
+  void encode_loop ()
+  {
+    for (int slot = m_to_encode.pop (); slot >= 0; slot = m_to_encode.pop ())
+      {
+        Stripe &stripe = m_stripes[slot];
+        m_codec.encode (stripe.shards.data (), stripe.shards.data () + m_codec.data_shards (), m_shard_len);
+        m_to_write.push (slot);
+      }
+
+    m_to_write.push (-1);
+  }
+
+  void write_loop ()
+  {
+    for (int slot = m_to_write.pop (); slot >= 0; slot = m_to_write.pop ())
+      {
+        m_callback (m_stripes[slot]);
+        m_free.push (slot);
+      }
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_STREAM_ENCODER_HPP
@@ -0,0 +1,386 @@
+#ifndef GF256_TOWER_HPP
+#define GF256_TOWER_HPP
+
+#include "Matrix.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace GF256
+{
+
+// Tower fields over GF256: GF65536 = GF256[y] / (y^2 + y + lambda) and GF2_32 = GF65536[z] / (z^2 + z + mu),
+// each lambda the smallest constant (by representation) of absolute trace 1, which is what makes the quadratic
+// irreducible. An element is low + high * y, and its rep () holds low in the low half and high in the high one.
+// Multiplication by a constant c is GF256-linear, so on a buffer split into planes of GF256 coordinates it is
+// a degree x degree GF256 matrix (mul_matrix (c)) applied with the bulk kernels.
+template <class Base, class Rep>
+class QuadraticExtension;
+
+namespace tower_impl
+{
+template <class T>
+struct Traits
+{
+  using rep_type = typename T::rep_type;
+  static constexpr int degree = T::degree;
+  static constexpr rep_type rep (T x)             {return x.rep ();}
+  static constexpr T from_rep (rep_type rep)     {return T::from_rep (rep);}
+};
+
+template <>
+struct Traits<Element>
+{
+  using rep_type = unsigned char;
+  static constexpr int degree = 1;
+  static constexpr rep_type rep (Element x)         {return x.additive_rep ();}
+  static constexpr Element from_rep (rep_type rep) {return Element (rep);}
+};
+
+// x + x^2 + x^4 + ..., 0 or 1 in any field of characteristic 2
+template <class T>
+constexpr T absolute_trace (T x)
+{
+  T sum = x;
+  for (int i = 1; i < 8 * Traits<T>::degree; i++)
+    {
+      x = x * x;
+      sum = sum + x;
+    }
+  return sum;
+}
+
+// y^2 + y + lambda is irreducible over T exactly when lambda has absolute trace 1
+template <class T>
+constexpr T smallest_trace_one ()
+{
+  for (uint32_t rep = 1;; rep++)
+    {
+      T lambda = Traits<T>::from_rep (static_cast<typename Traits<T>::rep_type> (rep));
+      if (absolute_trace (lambda) == Traits<T>::from_rep (1))
+        return lambda;
+    }
+}
+} //namespace tower_impl
+
+template <class Base, class Rep>
+class QuadraticExtension
+{
+  Base m_low;
+  Base m_high;
+
+  static constexpr int half_bits = 8 * tower_impl::Traits<Base>::degree;
+
+public:
+  using base_type = Base;
+  using rep_type = Rep;
+  static constexpr int degree = 2 * tower_impl::Traits<Base>::degree; // over GF256
+  static constexpr Base lambda = tower_impl::smallest_trace_one<Base> ();
+
+  constexpr QuadraticExtension () {}
+  constexpr QuadraticExtension (Base low, Base high) : m_low (low), m_high (high) {}
+  constexpr explicit QuadraticExtension (Base low) : m_low (low) {}
+
+  static constexpr QuadraticExtension from_rep (Rep rep)
+  {
+    using BaseRep = typename tower_impl::Traits<Base>::rep_type;
+    return {tower_impl::Traits<Base>::from_rep (static_cast<BaseRep> (rep)),
+            tower_impl::Traits<Base>::from_rep (static_cast<BaseRep> (rep >> half_bits))};
+  }
+
+  constexpr Rep rep () const
+  {
+    return static_cast<Rep> (tower_impl::Traits<Base>::rep (m_low)
+                             | static_cast<Rep> (tower_impl::Traits<Base>::rep (m_high)) << half_bits);
+  }
+
+  constexpr Base low () const  {return m_low;}
+  constexpr Base high () const {return m_high;}
+
+  // (high * y + low) * (high * y + low + high) = low^2 + low * high + lambda * high^2 lies in Base
+  constexpr QuadraticExtension inv () const
+  {
+    Base norm = m_low * m_low + m_low * m_high + lambda * m_high * m_high;
+    if (norm == Base ())
+      std::terminate (); // zero element has no inverse
+
+    Base scale = norm.inv ();
+    return {(m_low + m_high) * scale, m_high * scale};
+  }
+
+  constexpr QuadraticExtension pow (uint64_t power) const
+  {
+    QuadraticExtension result = from_rep (1);
+    QuadraticExtension square = *this;
+    for (; power; power >>= 1)
+      {
+        if (power & 1)
+          result = result * square;
+        square = square * square;
+      }
+    return result;
+  }
+
+  // Karatsuba: three Base products and one by lambda
+  friend constexpr QuadraticExtension operator * (QuadraticExtension lhs, QuadraticExtension rhs)
+  {
+    Base high = lhs.m_high * rhs.m_high;
+    Base low = lhs.m_low * rhs.m_low;
+    Base middle = (lhs.m_low + lhs.m_high) * (rhs.m_low + rhs.m_high);
+    return {low + lambda * high, middle + low};
+  }
+
+  friend constexpr QuadraticExtension operator + (QuadraticExtension lhs, QuadraticExtension rhs)
+  {
+    return {lhs.m_low + rhs.m_low, lhs.m_high + rhs.m_high};
+  }
+
+  friend constexpr QuadraticExtension operator - (QuadraticExtension lhs, QuadraticExtension rhs) {return lhs + rhs;}
+  friend constexpr QuadraticExtension operator / (QuadraticExtension lhs, QuadraticExtension rhs) {return lhs * rhs.inv ();}
+
+  constexpr QuadraticExtension &operator += (QuadraticExtension rhs) {return *this = *this + rhs;}
+  constexpr QuadraticExtension &operator -= (QuadraticExtension rhs) {return *this = *this - rhs;}
+  constexpr QuadraticExtension &operator *= (QuadraticExtension rhs) {return *this = *this * rhs;}
+  constexpr QuadraticExtension &operator /= (QuadraticExtension rhs) {return *this = *this / rhs;}
+
+  friend constexpr bool operator == (QuadraticExtension lhs, QuadraticExtension rhs)
+  {
+    return lhs.m_low == rhs.m_low && lhs.m_high == rhs.m_high;
+  }
+
+  friend constexpr bool operator != (QuadraticExtension lhs, QuadraticExtension rhs) {return !(lhs == rhs);}
+};
+
+using GF65536 = QuadraticExtension<Element, uint16_t>;
+using GF2_32 = QuadraticExtension<GF65536, uint32_t>;
+
+static_assert (GF65536::lambda != Element () && GF2_32::lambda.high () != Element (),
+               "a constant of trace 1 over GF65536 lies outside GF256");
+
+// (i, j) is coordinate i of c * (the basis element of coordinate j), so multiplying the plane vector
+// of x by it gives the planes of c * x.
+template <class Field>
+inline Matrix mul_matrix (Field c)
+{
+  const int degree = Field::degree;
+  Matrix result (degree, degree);
+  for (int j = 0; j < degree; j++)
+    {
+      auto product = (c * Field::from_rep (static_cast<typename Field::rep_type> (1) << (8 * j))).rep ();
+      for (int i = 0; i < degree; i++)
+        result (i, j) = Element (static_cast<unsigned char> (product >> (8 * i)));
+    }
+  return result;
+}
+
+// mul_matrix (c) expanded for the region functions below, to multiply many regions by the same c
+template <class Field>
+inline Tables mul_tables (Field c)
+{
+  return expand_coefficients (mul_matrix (c));
+}
+
+// Buffers of Field symbols are split into degree planes: len bytes hold len / degree symbols, coordinate p of
+// symbol s at byte p * len / degree + s. Any byte buffer of a multiple of degree bytes can be read this way.
+// dst = c * src and dst += c * src, with tables from mul_tables (c); dst must not overlap src. Every plane of
+// src and dst is read once.
+inline void mul_region (const Tables &tables, const Element *src, Element *dst, size_t len, bool accumulate = false)
+{
+  const int degree = tables.rows ();
+  if (len % degree != 0)
+    std::terminate (); // not a whole number of symbols
+
+  const size_t plane = len / degree;
+  std::vector<const Element *> srcs (degree);
+  std::vector<Element *> dsts (degree);
+  for (int p = 0; p < degree; p++)
+    {
+      srcs[p] = src + p * plane;
+      dsts[p] = dst + p * plane;
+    }
+
+  dot_product_multi (tables, srcs.data (), dsts.data (), plane, accumulate);
+}
+
+inline void mul_add_region (const Tables &tables, const Element *src, Element *dst, size_t len)
+{
+  mul_region (tables, src, dst, len, true);
+}
+
+template <class Base, class Rep>
+inline void mul_region (QuadraticExtension<Base, Rep> c, const Element *src, Element *dst, size_t len)
+{
+  mul_region (mul_tables (c), src, dst, len);
+}
+
+template <class Base, class Rep>
+inline void mul_add_region (QuadraticExtension<Base, Rep> c, const Element *src, Element *dst, size_t len)
+{
+  mul_add_region (mul_tables (c), src, dst, len);
+}
+
+// Systematic Cauchy Reed-Solomon codec over a tower field, for stripes of more than 256 shards: up to 65536
+// over GF65536. Every shard is len bytes in the plane layout above, len a multiple of Field::degree. The
+// coding matrix is kept expanded over GF256, each Field coefficient becoming its mul_matrix block, so
+// encoding and decoding are GF256 dot products over planes, on the same SIMD kernels as ReedSolomon.
+template <class Field>
+class WideReedSolomon
+{
+public:
+  struct Decoder
+  {
+    std::vector<int> rows;  // shards the stripe is decoded from
+    Tables inverse_tables;  // data planes = inverse * (planes of the shards listed in rows), over GF256
+  };
+
+private:
+  static constexpr int degree = Field::degree;
+
+  int m_data_shards = 0;
+  int m_parity_shards = 0;
+  Matrix m_encode_matrix;  // GF256 expansion, total_shards () * degree x data_shards () * degree
+  Tables m_parity_tables;  // its parity rows, expanded once
+
+  mutable std::mutex m_decoders_mutex;
+  mutable std::map<std::vector<bool>, Decoder> m_decoders;
+
+  std::vector<const Element *> planes (const Element *const *shards, const std::vector<int> &rows, size_t len) const
+  {
+    std::vector<const Element *> result;
+    for (int shard : rows)
+      for (int p = 0; p < degree; p++)
+        result.push_back (shards[shard] + p * (len / degree));
+    return result;
+  }
+
+public:
+  WideReedSolomon (int data_shards, int parity_shards)
+    : m_data_shards (data_shards), m_parity_shards (parity_shards)
+  {
+    if (data_shards <= 0 || parity_shards < 0
+        || static_cast<uint64_t> (data_shards) + parity_shards > (uint64_t (1) << (8 * degree)))
+      std::terminate (); // the field has no room for such a code
+
+    // parity (i, j) = 1 / (x_i + y_j), x_i = data_shards + i, y_j = j
+    const int n = data_shards + parity_shards;
+    m_encode_matrix = Matrix (n * degree, data_shards * degree);
+    for (int i = 0; i < data_shards * degree; i++)
+      m_encode_matrix (i, i) = neutral_mult_element ();
+
+    for (int i = 0; i < parity_shards; i++)
+      for (int j = 0; j < data_shards; j++)
+        {
+          using FieldRep = typename Field::rep_type;
+          Field x = Field::from_rep (static_cast<FieldRep> (data_shards + i));
+          Field y = Field::from_rep (static_cast<FieldRep> (j));
+          Matrix block = mul_matrix ((x + y).inv ());
+          for (int p = 0; p < degree; p++)
+            std::copy (block.row (p), block.row (p) + degree, m_encode_matrix.row ((data_shards + i) * degree + p) + j * degree);
+        }
+
+    m_parity_tables = expand_coefficients (m_encode_matrix.row (data_shards * degree), parity_shards * degree,
+                                           data_shards * degree);
+  }
+
+  int data_shards () const   {return m_data_shards;}
+  int parity_shards () const {return m_parity_shards;}
+  int total_shards () const  {return m_data_shards + m_parity_shards;}
+
+  // the GF256 expansion of the (data_shards + parity_shards) x data_shards coding matrix
+  const Matrix &encode_matrix () const {return m_encode_matrix;}
+
+  Field coefficient (int parity, int data) const
+  {
+    typename Field::rep_type rep = 0;
+    for (int p = 0; p < degree; p++)
+      rep |= static_cast<typename Field::rep_type> (m_encode_matrix ((m_data_shards + parity) * degree + p, data * degree).additive_rep ())
+             << (8 * p);
+    return Field::from_rep (rep);
+  }
+
+  void encode (const Element *const *data, Element *const *parity, size_t len) const
+  {
+    if (len % degree != 0)
+      std::terminate (); // not a whole number of symbols
+
+    std::vector<int> rows (m_data_shards);
+    for (int i = 0; i < m_data_shards; i++)
+      rows[i] = i;
+
+    std::vector<const Element *> srcs = planes (data, rows, len);
+    std::vector<Element *> dsts;
+    for (int i = 0; i < m_parity_shards; i++)
+      for (int p = 0; p < degree; p++)
+        dsts.push_back (parity[i] + p * (len / degree));
+
+    dot_product_multi (m_parity_tables, srcs.data (), dsts.data (), len / degree);
+  }
+
+  // Decoding matrix for the given set of surviving shards, computed once per pattern.
+  // Returns nullptr when fewer than data_shards shards survive.
+  const Decoder *decoder (const std::vector<bool> &present) const
+  {
+    std::lock_guard<std::mutex> lock (m_decoders_mutex);
+
+    auto it = m_decoders.find (present);
+    if (it != m_decoders.end ())
+      return &it->second;
+
+    Decoder decoder;
+    std::vector<int> expanded_rows;
+    for (int i = 0; i < total_shards () && static_cast<int> (decoder.rows.size ()) < m_data_shards; i++)
+      if (present[i])
+        {
+          decoder.rows.push_back (i);
+          for (int p = 0; p < degree; p++)
+            expanded_rows.push_back (i * degree + p);
+        }
+
+    if (static_cast<int> (decoder.rows.size ()) < m_data_shards)
+      return nullptr;
+
+    auto inverse = m_encode_matrix.select_rows (expanded_rows).inverse ();
+    if (!inverse)
+      return nullptr;
+
+    decoder.inverse_tables = expand_coefficients (*inverse);
+    return &m_decoders.emplace (present, std::move (decoder)).first->second;
+  }
+
+  // Rebuilds every shard that is not marked present. Returns false if the stripe is lost.
+  bool reconstruct (Element *const *shards, const std::vector<bool> &present, size_t len) const
+  {
+    if (len % degree != 0)
+      std::terminate (); // not a whole number of symbols
+
+    const Decoder *dec = decoder (present);
+    if (!dec)
+      return false;
+
+    const size_t plane = len / degree;
+    const int count = m_data_shards * degree;
+    std::vector<const Element *> sources = planes (shards, dec->rows, len);
+    for (int i = 0; i < m_data_shards; i++)
+      if (!present[i])
+        for (int p = 0; p < degree; p++)
+          dot_product (dec->inverse_tables.row (i * degree + p), sources.data (), count, shards[i] + p * plane, plane);
+
+    std::vector<int> data_rows (m_data_shards);
+    for (int i = 0; i < m_data_shards; i++)
+      data_rows[i] = i;
+    std::vector<const Element *> data = planes (shards, data_rows, len);
+    for (int i = m_data_shards; i < total_shards (); i++)
+      if (!present[i])
+        for (int p = 0; p < degree; p++)
+          dot_product (m_parity_tables.row ((i - m_data_shards) * degree + p), data.data (), count,
+                       shards[i] + p * plane, plane);
+
+    return true;
+  }
+};
+
+} //namespace GF256
+
+#endif // GF256_TOWER_HPP
@@ -0,0 +1,385 @@
+#ifndef GF256_VEC_HPP
+#define GF256_VEC_HPP
+
+#include "GF256.hpp"
+#include "impl/bulk.hpp"
+
+#include <array>
+#include <cstring>
+#include <span>
+
+#if defined (__SSSE3__)
+#include <immintrin.h>
+#endif
+
+namespace GF256
+{
+
+// N packed Elements with the operators of Element, for field code written once and run at vector width.
+// The instructions are picked at compile time: table lookups are PSHUFB on 64, 32 or 16 bytes with AVX-512BW,
+// AVX2 or SSSE3 and a plain loop otherwise, the rest is generic vector code on 16-byte slices that the compiler
+// widens as the target allows. Multiplication by an Element goes through its nibble tables, multiplication
+// of two vectors shifts and adds bit by bit, and inversion looks the lanes up 16 table entries at a time.
+namespace vec_impl
+{
+// 16 Elements, an SSE register; wider GCC vectors would change the ABI with the target
+using Slice = unsigned char __attribute__ ((vector_size (16)));
+
+inline constexpr unsigned char reduction = (Element (static_cast<unsigned char> (0x80))
+                                            * Element (static_cast<unsigned char> (2))).additive_rep ();
+
+// inverses of every element, zero for zero
+inline constexpr std::array<unsigned char, 256> inverse = []
+{
+  std::array<unsigned char, 256> table {};
+  for (int i = 1; i < 256; i++)
+    table[i] = Element (static_cast<unsigned char> (i)).inv ().additive_rep ();
+  return table;
+} ();
+
+// out[i] = table[index[i]] for N indices below 16
+template <int N>
+inline void lookup16 (const unsigned char *table, const Slice *index, Slice *out)
+{
+  const unsigned char *in = reinterpret_cast<const unsigned char *> (index);
+  unsigned char *result = reinterpret_cast<unsigned char *> (out);
+#if defined (__AVX512BW__)
+  if constexpr (N % 64 == 0)
+    {
+      __m512i t = _mm512_maskz_broadcast_i32x4 (0xffff, _mm_loadu_si128 (reinterpret_cast<const __m128i *> (table)));
+      for (int i = 0; i < N; i += 64)
+        _mm512_storeu_si512 (result + i, _mm512_shuffle_epi8 (t, _mm512_loadu_si512 (in + i)));
+      return;
+    }
+#endif
+#if defined (__AVX2__)
+  if constexpr (N % 32 == 0)
+    {
+      __m256i t = _mm256_broadcastsi128_si256 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (table)));
+      for (int i = 0; i < N; i += 32)
+        _mm256_storeu_si256 (reinterpret_cast<__m256i *> (result + i),
+                             _mm256_shuffle_epi8 (t, _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (in + i))));
+      return;
+    }
+#endif
+#if defined (__SSSE3__)
+  __m128i t = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (table));
+  for (int i = 0; i < N; i += 16)
+    _mm_storeu_si128 (reinterpret_cast<__m128i *> (result + i),
+                      _mm_shuffle_epi8 (t, _mm_loadu_si128 (reinterpret_cast<const __m128i *> (in + i))));
+#else
+  for (int i = 0; i < N; i++)
+    result[i] = table[in[i]];
+#endif
+}
+
+// table[index[i]] for indices below 16, PSHUFB of a single slice
+inline Slice shuffle (Slice table, Slice index)
+{
+#if defined (__SSSE3__)
+  return reinterpret_cast<Slice> (_mm_shuffle_epi8 (reinterpret_cast<__m128i> (table), reinterpret_cast<__m128i> (index)));
+#else
+  Slice result;
+  for (int i = 0; i < 16; i++)
+    result[i] = table[index[i]];
+  return result;
+#endif
+}
+
+// out[i] = table[index[i]] for a 256-entry table, one 16-entry lookup per high nibble
+template <int N>
+inline void lookup256 (const unsigned char *table, const Slice *index, Slice *out)
+{
+  const int slices = N / 16;
+  Slice low[slices], high[slices], result[slices];
+  for (int s = 0; s < slices; s++)
+    {
+      low[s] = index[s] & 0xf;
+      high[s] = index[s] >> 4;
+      result[s] = Slice {};
+    }
+
+  for (int h = 0; h < 16; h++)
+    {
+      Slice part;
+      memcpy (&part, table + 16 * h, 16);
+      for (int s = 0; s < slices; s++)
+        result[s] |= shuffle (part, low[s]) & reinterpret_cast<Slice> (high[s] == static_cast<unsigned char> (h));
+    }
+
+  for (int s = 0; s < slices; s++)
+    out[s] = result[s];
+}
+
+// 0xff in the lanes whose top bit is set
+inline Slice top_bits (Slice x)
+{
+  using Signed = signed char __attribute__ ((vector_size (16)));
+  return reinterpret_cast<Slice> (reinterpret_cast<Signed> (x) < 0);
+}
+
+// out = a * b lane by lane: Horner over the bits of b from the top, 8 steps whatever the values.
+// The steps of all slices are interleaved, each step depending on the previous one.
+template <int N>
+inline void mul (const Slice *a, const Slice *b, Slice *out)
+{
+  const int slices = N / 16;
+  Slice result[slices] = {}, bits[slices];
+  for (int s = 0; s < slices; s++)
+    bits[s] = b[s];
+
+  for (int i = 0; i < 8; i++)
+    for (int s = 0; s < slices; s++)
+      {
+        result[s] = (result[s] + result[s]) ^ (reduction & top_bits (result[s]));
+        result[s] ^= a[s] & top_bits (bits[s]);
+        bits[s] += bits[s];
+      }
+
+  for (int s = 0; s < slices; s++)
+    out[s] = result[s];
+}
+
+template <int N>
+inline bool any (const Slice *x)
+{
+  Slice acc {};
+  for (int s = 0; s < N / 16; s++)
+    acc |= x[s];
+
+  uint64_t words[2];
+  memcpy (words, &acc, sizeof (acc));
+  return (words[0] | words[1]) != 0;
+}
+} //namespace vec_impl
+
+template <int N>
+class Vec;
+
+// Result of comparing two Vecs, lane i set when the comparison holds for lane i.
+template <int N>
+class Mask
+{
+  using Slice = vec_impl::Slice;
+  static constexpr int slices = N / 16;
+
+  Slice m_bits[slices] {}; // 0xff or 0 per lane
+
+  friend class Vec<N>;
+
+public:
+  Mask () {}
+
+  // N / 16 slices of 0xff or 0 lanes
+  const Slice *bits () const {return m_bits;}
+
+  bool operator [] (int lane) const {return m_bits[lane / 16][lane % 16] != 0;}
+
+  bool any () const  {return vec_impl::any<N> (m_bits);}
+  bool all () const  {return (!*this).none ();}
+  bool none () const {return !any ();}
+
+  int count () const
+  {
+    int result = 0;
+    for (int i = 0; i < N; i++)
+      result += (*this)[i];
+    return result;
+  }
+
+  friend Mask operator & (Mask lhs, Mask rhs)
+  {
+    for (int s = 0; s < slices; s++)
+      lhs.m_bits[s] &= rhs.m_bits[s];
+    return lhs;
+  }
+
+  friend Mask operator | (Mask lhs, Mask rhs)
+  {
+    for (int s = 0; s < slices; s++)
+      lhs.m_bits[s] |= rhs.m_bits[s];
+    return lhs;
+  }
+
+  friend Mask operator ^ (Mask lhs, Mask rhs)
+  {
+    for (int s = 0; s < slices; s++)
+      lhs.m_bits[s] ^= rhs.m_bits[s];
+    return lhs;
+  }
+
+  friend Mask operator ! (Mask mask)
+  {
+    for (int s = 0; s < slices; s++)
+      mask.m_bits[s] = ~mask.m_bits[s];
+    return mask;
+  }
+};
+
+template <int N>
+class Vec
+{
+  static_assert (N == 16 || N == 32 || N == 64, "Vec holds 16, 32 or 64 Elements");
+
+  using Slice = vec_impl::Slice;
+  static constexpr int slices = N / 16;
+
+  Slice m_slices[slices] {};
+
+  template <class Compare>
+  static Mask<N> compare (const Vec &lhs, const Vec &rhs, Compare compare)
+  {
+    Mask<N> result;
+    for (int s = 0; s < slices; s++)
+      result.m_bits[s] = reinterpret_cast<Slice> (compare (lhs.m_slices[s], rhs.m_slices[s]));
+    return result;
+  }
+
+public:
+  static constexpr int size () {return N;}
+
+  Vec () {}
+
+  // every lane equal to value
+  Vec (Element value)
+  {
+    for (int s = 0; s < slices; s++)
+      m_slices[s] = Slice {} + value.additive_rep ();
+  }
+
+  explicit Vec (std::span<const Element, N> src)
+  {
+    memcpy (m_slices, bulk_impl::bytes (src.data ()), N);
+  }
+
+  // the first N Elements of src, which must hold that many
+  static Vec load (std::span<const Element> src)
+  {
+    if (src.size () < N)
+      std::terminate (); // not enough Elements to load
+    return Vec (src.template first<N> ());
+  }
+
+  // to the first N Elements of dst, which must hold that many
+  void store (std::span<Element> dst) const
+  {
+    if (dst.size () < N)
+      std::terminate (); // not enough room to store
+    memcpy (bulk_impl::bytes (dst.data ()), m_slices, N);
+  }
+
+  Element operator [] (int lane) const {return Element (m_slices[lane / 16][lane % 16]);}
+
+  // every lane to the power, zero lanes stay zero as with Element::pow
+  Vec pow (int power) const
+  {
+    int exponent = power % 255;
+    if (exponent < 0)
+      exponent += 255;
+
+    Vec result (neutral_mult_element ());
+    Vec base = *this;
+    for (; exponent; exponent >>= 1)
+      {
+        if (exponent & 1)
+          result *= base;
+        base *= base;
+      }
+    return select (*this != Vec (), result, Vec ());
+  }
+
+  Vec inv () const
+  {
+    if ((*this == Vec ()).any ())
+      std::terminate (); // zero element has no inverse
+
+    Vec result;
+    vec_impl::lookup256<N> (vec_impl::inverse.data (), m_slices, result.m_slices);
+    return result;
+  }
+
+  Vec &operator += (const Vec &rhs)
+  {
+    for (int s = 0; s < slices; s++)
+      m_slices[s] ^= rhs.m_slices[s];
+    return *this;
+  }
+
+  Vec &operator -= (const Vec &rhs) {return *this += rhs;}
+
+  Vec &operator *= (const Vec &rhs)
+  {
+    vec_impl::mul<N> (m_slices, rhs.m_slices, m_slices);
+    return *this;
+  }
+
+  Vec &operator *= (Element rhs)
+  {
+    // the nibble tables themselves are two vector products
+    const Slice nibbles = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    const Slice coef = Slice {} + rhs.additive_rep ();
+    NibbleTable table;
+    Slice factors[2] = {nibbles, nibbles << 4};
+    Slice coefs[2] = {coef, coef};
+    Slice products[2];
+    vec_impl::mul<32> (factors, coefs, products);
+    memcpy (table.low, &products[0], 16);
+    memcpy (table.high, &products[1], 16);
+
+    Slice low[slices], high[slices];
+    for (int s = 0; s < slices; s++)
+      {
+        low[s] = m_slices[s] & 0xf;
+        high[s] = m_slices[s] >> 4;
+      }
+
+    vec_impl::lookup16<N> (table.low, low, low);
+    vec_impl::lookup16<N> (table.high, high, high);
+    for (int s = 0; s < slices; s++)
+      m_slices[s] = low[s] ^ high[s];
+    return *this;
+  }
+
+  Vec &operator /= (const Vec &rhs) {return *this *= rhs.inv ();}
+  Vec &operator /= (Element rhs)    {return *this *= rhs.inv ();}
+
+  friend Vec operator + (Vec lhs, const Vec &rhs)  {return lhs += rhs;}
+  friend Vec operator - (Vec lhs, const Vec &rhs)  {return lhs -= rhs;}
+  friend Vec operator * (Vec lhs, const Vec &rhs)  {return lhs *= rhs;}
+  friend Vec operator * (Vec lhs, Element rhs)     {return lhs *= rhs;}
+  friend Vec operator * (Element lhs, Vec rhs)     {return rhs *= lhs;}
+  friend Vec operator / (Vec lhs, const Vec &rhs)  {return lhs /= rhs;}
+  friend Vec operator / (Vec lhs, Element rhs)     {return lhs /= rhs;}
+  friend Vec operator / (Element lhs, const Vec &rhs) {return Vec (lhs) /= rhs;}
+
+  friend Mask<N> operator == (const Vec &lhs, const Vec &rhs) {return compare (lhs, rhs, [] (Slice a, Slice b) {return a == b;});}
+  friend Mask<N> operator != (const Vec &lhs, const Vec &rhs) {return compare (lhs, rhs, [] (Slice a, Slice b) {return a != b;});}
+  friend Mask<N> operator < (const Vec &lhs, const Vec &rhs)  {return compare (lhs, rhs, [] (Slice a, Slice b) {return a < b;});}
+  friend Mask<N> operator > (const Vec &lhs, const Vec &rhs)  {return compare (lhs, rhs, [] (Slice a, Slice b) {return a > b;});}
+  friend Mask<N> operator <= (const Vec &lhs, const Vec &rhs) {return compare (lhs, rhs, [] (Slice a, Slice b) {return a <= b;});}
+  friend Mask<N> operator >= (const Vec &lhs, const Vec &rhs) {return compare (lhs, rhs, [] (Slice a, Slice b) {return a >= b;});}
+
+  // lanes of if_true where mask is set, of if_false elsewhere
+  friend Vec select (const Mask<N> &mask, Vec if_true, const Vec &if_false)
+  {
+    for (int s = 0; s < slices; s++)
+      if_true.m_slices[s] = (if_true.m_slices[s] & mask.bits ()[s]) | (if_false.m_slices[s] & ~mask.bits ()[s]);
+    return if_true;
+  }
+};
+
+template <int N>
+inline Vec<N> pow (const Vec<N> &base, int power)
+{
+  return base.pow (power);
+}
+
+template <int N>
+inline Vec<N> inv (const Vec<N> &src)
+{
+  return src.inv ();
+}
+
+} //namespace GF256
+
+#endif // GF256_VEC_HPP
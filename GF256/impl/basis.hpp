@@ -0,0 +1,341 @@
+#ifndef BASIS_HPP
+#define BASIS_HPP
+
+#include "bulk.hpp"
+
+#include <cstdint>
+
+#if defined (__GNUC__) && defined (__x86_64__)
+#include <immintrin.h>
+#define GF256_BASIS_X86 1
+#endif
+
+namespace GF256
+{
+
+// Conversion between the representations of GF(2^8) modulo different polynomials. All fields of order 256 are
+// isomorphic: sending x to a root r of the source polynomial in the target field is a field isomorphism, and it
+// is GF(2)-linear, so it is an 8x8 bit matrix. Roots of an irreducible polynomial are conjugates, the smallest
+// one (by representation) is used. An isomorphism maps primitive elements to primitive elements, so the
+// generator of one representation lands on a generator of the other.
+inline constexpr unsigned gf256_polynomial = 0x1c3; // x^8 + x^7 + x^6 + x + 1, the one of Element
+inline constexpr unsigned aes_polynomial = 0x11b;   // x^8 + x^4 + x^3 + x + 1, AES and GFNI GF2P8MULB
+inline constexpr unsigned raid6_polynomial = 0x11d; // x^8 + x^4 + x^3 + x^2 + 1, ISA-L, Jerasure, Linux RAID-6
+
+// 8x8 matrix over GF(2), column j is the image of bit j
+struct BitMatrix
+{
+  unsigned char columns[8] = {};
+};
+
+enum class BasisKernel
+{
+  scalar,
+  pshufb,     // the nibble tables of the bulk kernels, 16 bytes at a time
+  gfni,       // GF2P8AFFINEQB, 16 bytes at a time
+  gfni_avx512 // GF2P8AFFINEQB on AVX-512 registers, 64 bytes at a time
+};
+
+inline constexpr unsigned char apply (const BitMatrix &matrix, unsigned char x)
+{
+  unsigned char result = 0;
+  for (int j = 0; j < 8; j++)
+    if (x & (1 << j))
+      result ^= matrix.columns[j];
+  return result;
+}
+
+// lhs after rhs
+inline constexpr BitMatrix operator * (const BitMatrix &lhs, const BitMatrix &rhs)
+{
+  BitMatrix result;
+  for (int j = 0; j < 8; j++)
+    result.columns[j] = apply (lhs, rhs.columns[j]);
+  return result;
+}
+
+inline constexpr bool operator == (const BitMatrix &lhs, const BitMatrix &rhs)
+{
+  for (int j = 0; j < 8; j++)
+    if (lhs.columns[j] != rhs.columns[j])
+      return false;
+  return true;
+}
+
+// A singular matrix is a programmer error.
+inline constexpr BitMatrix inverse (const BitMatrix &matrix)
+{
+  BitMatrix result;
+  for (int j = 0; j < 8; j++)
+    {
+      int x = 0;
+      while (x < 256 && apply (matrix, static_cast<unsigned char> (x)) != (1 << j))
+        x++;
+      if (x == 256)
+        std::terminate (); // singular matrix
+      result.columns[j] = static_cast<unsigned char> (x);
+    }
+  return result;
+}
+
+// The operand of GF2P8AFFINEQB: byte 7 - i holds row i, the input bits that output bit i sums.
+inline constexpr uint64_t gfni_operand (const BitMatrix &matrix)
+{
+  uint64_t result = 0;
+  for (int i = 0; i < 8; i++)
+    for (int j = 0; j < 8; j++)
+      if (matrix.columns[j] & (1 << i))
+        result |= uint64_t (1) << (8 * (7 - i) + j);
+  return result;
+}
+
+inline constexpr NibbleTable nibble_table (const BitMatrix &matrix)
+{
+  NibbleTable table {};
+  for (int i = 0; i < 16; i++)
+    {
+      table.low[i] = apply (matrix, static_cast<unsigned char> (i));
+      table.high[i] = apply (matrix, static_cast<unsigned char> (i << 4));
+    }
+  return table;
+}
+
+namespace basis_impl
+{
+// a * b modulo polynomial, for any representation
+inline constexpr unsigned char mul (unsigned char a, unsigned char b, unsigned polynomial)
+{
+  unsigned product = 0;
+  unsigned shifted = a;
+  for (int j = 0; j < 8; j++)
+    {
+      if (b & (1 << j))
+        product ^= shifted;
+      shifted <<= 1;
+      if (shifted & 0x100)
+        shifted ^= polynomial;
+    }
+  return static_cast<unsigned char> (product);
+}
+} //namespace basis_impl
+
+// Representation modulo polynomial to the one of Element. A polynomial without a root in GF256 is not
+// irreducible of degree 8, and a programmer error.
+inline constexpr BitMatrix basis_to_gf256 (unsigned polynomial)
+{
+  for (int r = 0; r < 256; r++)
+    {
+      Element root (static_cast<unsigned char> (r));
+      Element value = Element ();
+      Element power = neutral_mult_element ();
+      for (int i = 0; i <= 8; i++, power *= root)
+        if (polynomial & (1u << i))
+          value += power;
+
+      if (value != Element ())
+        continue;
+
+      // bit j stands for x^j, which goes to root^j
+      BitMatrix result;
+      power = neutral_mult_element ();
+      for (int j = 0; j < 8; j++, power *= root)
+        result.columns[j] = power.additive_rep ();
+      return result;
+    }
+  std::terminate (); // the polynomial is not irreducible
+}
+
+inline constexpr BitMatrix basis_from_gf256 (unsigned polynomial)
+{
+  return inverse (basis_to_gf256 (polynomial));
+}
+
+// representation modulo from to the one modulo to
+inline constexpr BitMatrix basis_conversion (unsigned from, unsigned to)
+{
+  return basis_from_gf256 (to) * basis_to_gf256 (from);
+}
+
+// x -> c * x in the representation of Element
+inline constexpr BitMatrix mul_bit_matrix (Element c)
+{
+  BitMatrix result;
+  for (int j = 0; j < 8; j++)
+    result.columns[j] = (c * Element (static_cast<unsigned char> (1 << j))).additive_rep ();
+  return result;
+}
+
+namespace basis_impl
+{
+inline constexpr BitMatrix to_aes = basis_from_gf256 (aes_polynomial);
+inline constexpr BitMatrix from_aes = basis_to_gf256 (aes_polynomial);
+
+inline void convert_scalar (const NibbleTable &table, const unsigned char *src, unsigned char *dst, size_t first, size_t len)
+{
+  for (size_t i = first; i < len; i++)
+    dst[i] = bulk_impl::mul_byte (table, src[i]);
+}
+
+#ifdef __SSSE3__
+inline size_t convert_pshufb (const NibbleTable &table, const unsigned char *src, unsigned char *dst, size_t len)
+{
+  using namespace bulk_impl;
+  __m128i table_low = load (table.low);
+  __m128i table_high = load (table.high);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    store (dst + i, mul_block (table_low, table_high, load (src + i)));
+  return i;
+}
+#endif
+
+#ifdef GF256_BASIS_X86
+__attribute__ ((target ("gfni,sse2")))
+inline size_t convert_gfni (uint64_t operand, const unsigned char *src, unsigned char *dst, size_t len)
+{
+  const __m128i a = _mm_set1_epi64x (static_cast<long long> (operand));
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i x = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (src + i));
+      _mm_storeu_si128 (reinterpret_cast<__m128i *> (dst + i), _mm_gf2p8affine_epi64_epi8 (x, a, 0));
+    }
+  return i;
+}
+
+__attribute__ ((target ("gfni,avx512f,avx512bw")))
+inline size_t convert_gfni_avx512 (uint64_t operand, const unsigned char *src, unsigned char *dst, size_t len)
+{
+  const __m512i a = _mm512_set1_epi64 (static_cast<long long> (operand));
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64)
+    _mm512_storeu_si512 (dst + i, _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 (src + i), a, 0));
+  return i;
+}
+
+// lane by lane products through the AES representation, where GF2P8MULB multiplies
+__attribute__ ((target ("gfni,sse2")))
+inline size_t mul_lanes_gfni (const unsigned char *a, const unsigned char *b, unsigned char *dst, size_t len)
+{
+  const __m128i to = _mm_set1_epi64x (static_cast<long long> (gfni_operand (to_aes)));
+  const __m128i from = _mm_set1_epi64x (static_cast<long long> (gfni_operand (from_aes)));
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i x = _mm_gf2p8affine_epi64_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (a + i)), to, 0);
+      __m128i y = _mm_gf2p8affine_epi64_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (b + i)), to, 0);
+      _mm_storeu_si128 (reinterpret_cast<__m128i *> (dst + i), _mm_gf2p8affine_epi64_epi8 (_mm_gf2p8mul_epi8 (x, y), from, 0));
+    }
+  return i;
+}
+
+__attribute__ ((target ("gfni,avx512f,avx512bw")))
+inline size_t mul_lanes_gfni_avx512 (const unsigned char *a, const unsigned char *b, unsigned char *dst, size_t len)
+{
+  const __m512i to = _mm512_set1_epi64 (static_cast<long long> (gfni_operand (to_aes)));
+  const __m512i from = _mm512_set1_epi64 (static_cast<long long> (gfni_operand (from_aes)));
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64)
+    {
+      __m512i x = _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 (a + i), to, 0);
+      __m512i y = _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 (b + i), to, 0);
+      _mm512_storeu_si512 (dst + i, _mm512_gf2p8affine_epi64_epi8 (_mm512_gf2p8mul_epi8 (x, y), from, 0));
+    }
+  return i;
+}
+#endif
+} //namespace basis_impl
+
+// Widest kernel the running CPU supports, detected once.
+inline BasisKernel best_basis_kernel ()
+{
+#ifdef GF256_BASIS_X86
+  static const BasisKernel kernel =
+      __builtin_cpu_supports ("gfni") && __builtin_cpu_supports ("avx512bw") ? BasisKernel::gfni_avx512
+      : __builtin_cpu_supports ("gfni")                                       ? BasisKernel::gfni
+#ifdef __SSSE3__
+                                                                              : BasisKernel::pshufb;
+#else
+                                                                              : BasisKernel::scalar;
+#endif
+  return kernel;
+#elif defined (__SSSE3__)
+  return BasisKernel::pshufb;
+#else
+  return BasisKernel::scalar;
+#endif
+}
+
+inline bool basis_kernel_supported (BasisKernel kernel)
+{
+  return kernel <= best_basis_kernel ();
+}
+
+// dst[i] = matrix * src[i]; dst may be src. An unsupported kernel is a programmer error.
+inline void convert_region (const BitMatrix &matrix, const unsigned char *src, unsigned char *dst, size_t len,
+                            BasisKernel kernel = best_basis_kernel ())
+{
+  using namespace basis_impl;
+  if (!basis_kernel_supported (kernel))
+    std::terminate (); // the CPU lacks the instructions of this kernel
+
+  const NibbleTable table = nibble_table (matrix);
+  size_t done = 0;
+  switch (kernel)
+    {
+#ifdef GF256_BASIS_X86
+    case BasisKernel::gfni_avx512: done = convert_gfni_avx512 (gfni_operand (matrix), src, dst, len); break;
+    case BasisKernel::gfni:        done = convert_gfni (gfni_operand (matrix), src, dst, len); break;
+#endif
+#ifdef __SSSE3__
+    case BasisKernel::pshufb:      done = convert_pshufb (table, src, dst, len); break;
+#endif
+    default: break;
+    }
+  convert_scalar (table, src, dst, done, len);
+}
+
+// bytes in the representation modulo polynomial to Elements, and back
+inline void from_basis (unsigned polynomial, const unsigned char *src, Element *dst, size_t len,
+                        BasisKernel kernel = best_basis_kernel ())
+{
+  convert_region (basis_to_gf256 (polynomial), src, bulk_impl::bytes (dst), len, kernel);
+}
+
+inline void to_basis (unsigned polynomial, const Element *src, unsigned char *dst, size_t len,
+                      BasisKernel kernel = best_basis_kernel ())
+{
+  convert_region (basis_from_gf256 (polynomial), bulk_impl::bytes (src), dst, len, kernel);
+}
+
+// dst = c * src as the affine map of mul_bit_matrix (c): one GF2P8AFFINEQB per block on GFNI kernels
+inline void affine_mul_region (Element c, const Element *src, Element *dst, size_t len,
+                               BasisKernel kernel = best_basis_kernel ())
+{
+  convert_region (mul_bit_matrix (c), bulk_impl::bytes (src), bulk_impl::bytes (dst), len, kernel);
+}
+
+// dst[i] = a[i] * b[i]. GFNI kernels convert to the AES representation, multiply with GF2P8MULB
+// and convert back, three instructions per block.
+inline void mul_lanes (const Element *a, const Element *b, Element *dst, size_t len,
+                       BasisKernel kernel = best_basis_kernel ())
+{
+  using namespace basis_impl;
+  if (!basis_kernel_supported (kernel))
+    std::terminate (); // the CPU lacks the instructions of this kernel
+
+  size_t done = 0;
+#ifdef GF256_BASIS_X86
+  using bulk_impl::bytes;
+  if (kernel == BasisKernel::gfni_avx512)
+    done = mul_lanes_gfni_avx512 (bytes (a), bytes (b), bytes (dst), len);
+  else if (kernel == BasisKernel::gfni)
+    done = mul_lanes_gfni (bytes (a), bytes (b), bytes (dst), len);
+#endif
+  for (size_t i = done; i < len; i++)
+    dst[i] = a[i] * b[i];
+}
+
+} //namespace GF256
+
+#endif // BASIS_HPP
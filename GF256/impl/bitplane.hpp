@@ -0,0 +1,250 @@
+#ifndef BITPLANE_HPP
+#define BITPLANE_HPP
+
+#include "bulk.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined (__GNUC__) && defined (__x86_64__)
+#include <immintrin.h>
+#define GF256_BITPLANE_X86 1
+#endif
+
+namespace GF256
+{
+
+// Bit-plane layout of a buffer of len Elements: planes[b] holds bit b of every element,
+// bit i % 8 of planes[b][i / 8] being bit b of element i. Every plane is (len + 7) / 8 bytes,
+// unused bits of the last byte are zero.
+enum class BitplaneKernel
+{
+  scalar,
+  sse2,   // PMOVMSKB, 16 elements at a time
+  avx2,   // VPMOVMSKB, 32 elements at a time
+  avx512  // AVX-512BW mask registers, 64 elements at a time
+};
+
+namespace bitplane_impl
+{
+// 8x8 bit matrix transpose, bit 8 * r + c goes to 8 * c + r: 8 elements in, one byte of each plane out.
+inline uint64_t transpose8x8 (uint64_t x)
+{
+  uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+  x = x ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+  x = x ^ t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+  return x ^ t ^ (t << 28);
+}
+
+inline void to_bitplanes_scalar (const unsigned char *src, unsigned char *const *planes, size_t first, size_t len)
+{
+  for (size_t i = first; i < len; i += 8)
+    {
+      uint64_t block = 0;
+      memcpy (&block, src + i, std::min<size_t> (8, len - i));
+      block = transpose8x8 (block);
+      for (int b = 0; b < 8; b++)
+        planes[b][i / 8] = static_cast<unsigned char> (block >> (8 * b));
+    }
+}
+
+inline void from_bitplanes_scalar (const unsigned char *const *planes, unsigned char *dst, size_t first, size_t len)
+{
+  for (size_t i = first; i < len; i += 8)
+    {
+      uint64_t block = 0;
+      for (int b = 0; b < 8; b++)
+        block |= static_cast<uint64_t> (planes[b][i / 8]) << (8 * b);
+      block = transpose8x8 (block);
+      memcpy (dst + i, &block, std::min<size_t> (8, len - i));
+    }
+}
+
+#ifdef GF256_BITPLANE_X86
+// The vector kernels handle whole vectors and return how many elements they converted.
+// Plane bytes are written with memcpy, so planes need no alignment.
+
+inline size_t to_bitplanes_sse2 (const unsigned char *src, unsigned char *const *planes, size_t len)
+{
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i x = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (src + i));
+      for (int b = 7; b >= 0; b--)
+        {
+          uint16_t bits = static_cast<uint16_t> (_mm_movemask_epi8 (x));
+          memcpy (planes[b] + i / 8, &bits, 2);
+          x = _mm_add_epi8 (x, x);
+        }
+    }
+  return i;
+}
+
+inline size_t from_bitplanes_sse2 (const unsigned char *const *planes, unsigned char *dst, size_t len)
+{
+  const __m128i select = _mm_set1_epi64x (static_cast<long long> (0x8040201008040201ull));
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i acc = _mm_setzero_si128 ();
+      for (int b = 0; b < 8; b++)
+        {
+          uint16_t bits = 0;
+          memcpy (&bits, planes[b] + i / 8, 2);
+          // each of the two plane bytes repeated 8 times
+          __m128i bytes = _mm_cvtsi32_si128 (bits);
+          bytes = _mm_unpacklo_epi8 (bytes, bytes);
+          bytes = _mm_unpacklo_epi16 (bytes, bytes);
+          bytes = _mm_unpacklo_epi32 (bytes, bytes);
+          __m128i set = _mm_cmpeq_epi8 (_mm_and_si128 (bytes, select), select);
+          acc = _mm_or_si128 (acc, _mm_and_si128 (set, _mm_set1_epi8 (static_cast<char> (1 << b))));
+        }
+      _mm_storeu_si128 (reinterpret_cast<__m128i *> (dst + i), acc);
+    }
+  return i;
+}
+
+__attribute__ ((target ("avx2")))
+inline size_t to_bitplanes_avx2 (const unsigned char *src, unsigned char *const *planes, size_t len)
+{
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32)
+    {
+      __m256i x = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (src + i));
+      for (int b = 7; b >= 0; b--)
+        {
+          uint32_t bits = static_cast<uint32_t> (_mm256_movemask_epi8 (x));
+          memcpy (planes[b] + i / 8, &bits, 4);
+          x = _mm256_add_epi8 (x, x);
+        }
+    }
+  return i;
+}
+
+__attribute__ ((target ("avx2")))
+inline size_t from_bitplanes_avx2 (const unsigned char *const *planes, unsigned char *dst, size_t len)
+{
+  // byte j of the 32 plane bits goes to elements 8 j .. 8 j + 7
+  const __m256i spread = _mm256_setr_epi8 (0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                           2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+  const __m256i select = _mm256_set1_epi64x (static_cast<long long> (0x8040201008040201ull));
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32)
+    {
+      __m256i acc = _mm256_setzero_si256 ();
+      for (int b = 0; b < 8; b++)
+        {
+          uint32_t bits = 0;
+          memcpy (&bits, planes[b] + i / 8, 4);
+          __m256i bytes = _mm256_shuffle_epi8 (_mm256_set1_epi32 (static_cast<int> (bits)), spread);
+          __m256i set = _mm256_cmpeq_epi8 (_mm256_and_si256 (bytes, select), select);
+          acc = _mm256_or_si256 (acc, _mm256_and_si256 (set, _mm256_set1_epi8 (static_cast<char> (1 << b))));
+        }
+      _mm256_storeu_si256 (reinterpret_cast<__m256i *> (dst + i), acc);
+    }
+  return i;
+}
+
+__attribute__ ((target ("avx512f,avx512bw")))
+inline size_t to_bitplanes_avx512 (const unsigned char *src, unsigned char *const *planes, size_t len)
+{
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64)
+    {
+      __m512i x = _mm512_loadu_si512 (src + i);
+      for (int b = 0; b < 8; b++)
+        {
+          uint64_t bits = _mm512_test_epi8_mask (x, _mm512_set1_epi8 (static_cast<char> (1 << b)));
+          memcpy (planes[b] + i / 8, &bits, 8);
+        }
+    }
+  return i;
+}
+
+__attribute__ ((target ("avx512f,avx512bw")))
+inline size_t from_bitplanes_avx512 (const unsigned char *const *planes, unsigned char *dst, size_t len)
+{
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64)
+    {
+      __m512i acc = _mm512_setzero_si512 ();
+      for (int b = 0; b < 8; b++)
+        {
+          uint64_t bits = 0;
+          memcpy (&bits, planes[b] + i / 8, 8);
+          acc = _mm512_or_si512 (acc, _mm512_maskz_mov_epi8 (bits, _mm512_set1_epi8 (static_cast<char> (1 << b))));
+        }
+      _mm512_storeu_si512 (dst + i, acc);
+    }
+  return i;
+}
+#endif
+} //namespace bitplane_impl
+
+// Widest kernel the running CPU supports, detected once.
+inline BitplaneKernel best_bitplane_kernel ()
+{
+#ifdef GF256_BITPLANE_X86
+  static const BitplaneKernel kernel = __builtin_cpu_supports ("avx512bw") ? BitplaneKernel::avx512
+                                       : __builtin_cpu_supports ("avx2")   ? BitplaneKernel::avx2
+                                                                           : BitplaneKernel::sse2;
+  return kernel;
+#else
+  return BitplaneKernel::scalar;
+#endif
+}
+
+inline bool bitplane_kernel_supported (BitplaneKernel kernel)
+{
+  return kernel <= best_bitplane_kernel ();
+}
+
+// Element buffer to 8 bit planes. An unsupported kernel is a programmer error.
+inline void to_bitplanes (const Element *src, unsigned char *const *planes, size_t len,
+                          BitplaneKernel kernel = best_bitplane_kernel ())
+{
+  using namespace bitplane_impl;
+  if (!bitplane_kernel_supported (kernel))
+    std::terminate (); // the CPU lacks the instructions of this kernel
+
+  const unsigned char *s = bulk_impl::bytes (src);
+  size_t done = 0;
+#ifdef GF256_BITPLANE_X86
+  switch (kernel)
+    {
+    case BitplaneKernel::avx512: done = to_bitplanes_avx512 (s, planes, len); break;
+    case BitplaneKernel::avx2:   done = to_bitplanes_avx2 (s, planes, len); break;
+    case BitplaneKernel::sse2:   done = to_bitplanes_sse2 (s, planes, len); break;
+    case BitplaneKernel::scalar: break;
+    }
+#endif
+  to_bitplanes_scalar (s, planes, done, len);
+}
+
+// 8 bit planes back to an Element buffer.
+inline void from_bitplanes (const unsigned char *const *planes, Element *dst, size_t len,
+                            BitplaneKernel kernel = best_bitplane_kernel ())
+{
+  using namespace bitplane_impl;
+  if (!bitplane_kernel_supported (kernel))
+    std::terminate (); // the CPU lacks the instructions of this kernel
+
+  unsigned char *d = bulk_impl::bytes (dst);
+  size_t done = 0;
+#ifdef GF256_BITPLANE_X86
+  switch (kernel)
+    {
+    case BitplaneKernel::avx512: done = from_bitplanes_avx512 (planes, d, len); break;
+    case BitplaneKernel::avx2:   done = from_bitplanes_avx2 (planes, d, len); break;
+    case BitplaneKernel::sse2:   done = from_bitplanes_sse2 (planes, d, len); break;
+    case BitplaneKernel::scalar: break;
+    }
+#endif
+  from_bitplanes_scalar (planes, d, done, len);
+}
+
+} //namespace GF256
+
+#endif // BITPLANE_HPP
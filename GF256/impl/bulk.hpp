@@ -0,0 +1,542 @@
+#ifndef BULK_HPP
+#define BULK_HPP
+
+#include "../GF256.hpp"
+#include "crc32c.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace GF256
+{
+static_assert (sizeof (Element) == 1, "bulk kernels treat Element buffers as byte buffers");
+
+// Products of a coefficient with every low nibble and every high nibble.
+// c * x == low[x & 0xf] ^ high[x >> 4], which is what PSHUFB evaluates 16 bytes at a time.
+struct NibbleTable
+{
+  alignas (16) unsigned char low[16];
+  alignas (16) unsigned char high[16];
+};
+
+inline constexpr NibbleTable make_nibble_table (Element coef)
+{
+  NibbleTable table {};
+  for (int i = 0; i < 16; i++)
+    {
+      table.low[i] = (coef * Element (static_cast<unsigned char> (i))).additive_rep ();
+      table.high[i] = (coef * Element (static_cast<unsigned char> (i << 4))).additive_rep ();
+    }
+  return table;
+}
+
+inline std::vector<NibbleTable> make_nibble_tables (const Element *coefs, size_t count)
+{
+  std::vector<NibbleTable> tables (count);
+  for (size_t t = 0; t < count; t++)
+    tables[t] = make_nibble_table (coefs[t]);
+  return tables;
+}
+
+static_assert (sizeof (NibbleTable) == 32, "a NibbleTable is the 32-byte table of ISA-L's gf_vect_mul_init");
+
+// A rows x cols coefficient matrix expanded once, (r, c) at row (r)[c]. The bytes are the gftbls of ISA-L's
+// ec_init_tables: 32 bytes per coefficient, products of the low nibbles then of the high ones, row after row.
+// Only the layout is shared, the products are those of this field. Never modified after construction,
+// so one instance can be cached and used by any number of threads.
+class Tables
+{
+  int m_rows = 0;
+  int m_cols = 0;
+  std::vector<NibbleTable> m_tables;
+
+public:
+  Tables () {}
+
+  // coefs[r * cols + c] is the coefficient (r, c)
+  Tables (const Element *coefs, int rows, int cols)
+    : m_rows (rows), m_cols (cols), m_tables (make_nibble_tables (coefs, static_cast<size_t> (rows) * cols)) {}
+
+  int rows () const {return m_rows;}
+  int cols () const {return m_cols;}
+
+  const NibbleTable *row (int row) const                 {return m_tables.data () + static_cast<size_t> (row) * m_cols;}
+  const NibbleTable &operator () (int row, int col) const {return m_tables[static_cast<size_t> (row) * m_cols + col];}
+
+  // rows () * cols () * 32 bytes
+  const unsigned char *gftbls () const {return reinterpret_cast<const unsigned char *> (m_tables.data ());}
+  size_t gftbls_size () const         {return m_tables.size () * sizeof (NibbleTable);}
+};
+
+inline Tables expand_coefficients (const Element *coefs, int rows, int cols)
+{
+  return Tables (coefs, rows, cols);
+}
+
+namespace bulk_impl
+{
+inline unsigned char *bytes (Element *ptr)
+{
+  return reinterpret_cast<unsigned char *> (ptr);
+}
+
+inline const unsigned char *bytes (const Element *ptr)
+{
+  return reinterpret_cast<const unsigned char *> (ptr);
+}
+
+inline unsigned char mul_byte (const NibbleTable &table, unsigned char x)
+{
+  return table.low[x & 0xf] ^ table.high[x >> 4];
+}
+
+#ifdef __SSSE3__
+inline __m128i load (const unsigned char *ptr)
+{
+  return _mm_loadu_si128 (reinterpret_cast<const __m128i *> (ptr));
+}
+
+inline void store (unsigned char *ptr, __m128i value)
+{
+  _mm_storeu_si128 (reinterpret_cast<__m128i *> (ptr), value);
+}
+
+inline __m128i mul_block (__m128i table_low, __m128i table_high, __m128i x)
+{
+  const __m128i mask = _mm_set1_epi8 (0x0f);
+  __m128i low = _mm_and_si128 (x, mask);
+  __m128i high = _mm_and_si128 (_mm_srli_epi64 (x, 4), mask);
+  return _mm_xor_si128 (_mm_shuffle_epi8 (table_low, low), _mm_shuffle_epi8 (table_high, high));
+}
+
+inline uint32_t crc_block (uint32_t state, __m128i x)
+{
+  state = crc32c_update_u64 (state, static_cast<uint64_t> (_mm_cvtsi128_si64 (x)));
+  return crc32c_update_u64 (state, static_cast<uint64_t> (_mm_cvtsi128_si64 (_mm_srli_si128 (x, 8))));
+}
+#endif
+} //namespace bulk_impl
+
+// dst += src
+inline void add_region (const Element *src, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  const unsigned char *s = bytes (src);
+  unsigned char *d = bytes (dst);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; i + 16 <= len; i += 16)
+    store (d + i, _mm_xor_si128 (load (d + i), load (s + i)));
+#endif
+  for (; i < len; i++)
+    d[i] ^= s[i];
+}
+
+// dst = coef * src with the table of coef
+inline void mul_region (const NibbleTable &table, const Element *src, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  const unsigned char *s = bytes (src);
+  unsigned char *d = bytes (dst);
+  size_t i = 0;
+#ifdef __SSSE3__
+  __m128i table_low = load (table.low);
+  __m128i table_high = load (table.high);
+  for (; i + 16 <= len; i += 16)
+    store (d + i, mul_block (table_low, table_high, load (s + i)));
+#endif
+  for (; i < len; i++)
+    d[i] = mul_byte (table, s[i]);
+}
+
+// dst = coef * src
+inline void mul_region (Element coef, const Element *src, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  if (coef == zero_element ())
+    {
+      memset (bytes (dst), 0, len);
+      return;
+    }
+
+  if (coef == neutral_mult_element ())
+    {
+      memmove (dst, src, len);
+      return;
+    }
+
+  mul_region (make_nibble_table (coef), src, dst, len);
+}
+
+// dst += coef * src with the table of coef
+inline void mul_add_region (const NibbleTable &table, const Element *src, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  const unsigned char *s = bytes (src);
+  unsigned char *d = bytes (dst);
+  size_t i = 0;
+#ifdef __SSSE3__
+  __m128i table_low = load (table.low);
+  __m128i table_high = load (table.high);
+  for (; i + 16 <= len; i += 16)
+    store (d + i, _mm_xor_si128 (load (d + i), mul_block (table_low, table_high, load (s + i))));
+#endif
+  for (; i < len; i++)
+    d[i] ^= mul_byte (table, s[i]);
+}
+
+// dst += coef * src
+inline void mul_add_region (Element coef, const Element *src, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  if (coef == zero_element ())
+    return;
+
+  if (coef == neutral_mult_element ())
+    {
+      add_region (src, dst, len);
+      return;
+    }
+
+  mul_add_region (make_nibble_table (coef), src, dst, len);
+}
+
+// dst = sum of c[j] * srcs[j] with tables[j] expanded from c[j]
+// Every block of dst is accumulated in registers and written exactly once.
+inline void dot_product (const NibbleTable *tables, const Element *const *srcs, int count, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  if (count == 0)
+    {
+      memset (bytes (dst), 0, len);
+      return;
+    }
+
+  unsigned char *d = bytes (dst);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; i + 32 <= len; i += 32)
+    {
+      __m128i acc0 = _mm_setzero_si128 ();
+      __m128i acc1 = _mm_setzero_si128 ();
+      for (int j = 0; j < count; j++)
+        {
+          const unsigned char *s = bytes (srcs[j]) + i;
+          __m128i table_low = load (tables[j].low);
+          __m128i table_high = load (tables[j].high);
+          acc0 = _mm_xor_si128 (acc0, mul_block (table_low, table_high, load (s)));
+          acc1 = _mm_xor_si128 (acc1, mul_block (table_low, table_high, load (s + 16)));
+        }
+      store (d + i, acc0);
+      store (d + i + 16, acc1);
+    }
+#endif
+  for (; i < len; i++)
+    {
+      unsigned char acc = 0;
+      for (int j = 0; j < count; j++)
+        acc ^= mul_byte (tables[j], bytes (srcs[j])[i]);
+      d[i] = acc;
+    }
+}
+
+// dst = coefs[0] * srcs[0] + ... + coefs[count - 1] * srcs[count - 1]
+inline void dot_product (const Element *coefs, const Element *const *srcs, int count, Element *dst, size_t len)
+{
+  dot_product (make_nibble_tables (coefs, count).data (), srcs, count, dst, len);
+}
+
+// Checks expected == sum of c[j] * srcs[j], tables[j] expanded from c[j], without writing anything.
+// Returns false as soon as a 32-byte block differs.
+inline bool dot_product_equals (const NibbleTable *tables, const Element *const *srcs, int count,
+                                const Element *expected, size_t len)
+{
+  using namespace bulk_impl;
+  const unsigned char *e = bytes (expected);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; i + 32 <= len; i += 32)
+    {
+      __m128i acc0 = load (e + i);
+      __m128i acc1 = load (e + i + 16);
+      for (int j = 0; j < count; j++)
+        {
+          const unsigned char *s = bytes (srcs[j]) + i;
+          __m128i table_low = load (tables[j].low);
+          __m128i table_high = load (tables[j].high);
+          acc0 = _mm_xor_si128 (acc0, mul_block (table_low, table_high, load (s)));
+          acc1 = _mm_xor_si128 (acc1, mul_block (table_low, table_high, load (s + 16)));
+        }
+
+      __m128i diff = _mm_or_si128 (acc0, acc1);
+      if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (diff, _mm_setzero_si128 ())) != 0xffff)
+        return false;
+    }
+#endif
+  for (; i < len; i++)
+    {
+      unsigned char acc = e[i];
+      for (int j = 0; j < count; j++)
+        acc ^= mul_byte (tables[j], bytes (srcs[j])[i]);
+      if (acc)
+        return false;
+    }
+
+  return true;
+}
+
+// Checks expected == coefs[0] * srcs[0] + ... + coefs[count - 1] * srcs[count - 1]
+inline bool dot_product_equals (const Element *coefs, const Element *const *srcs, int count, const Element *expected, size_t len)
+{
+  return dot_product_equals (make_nibble_tables (coefs, count).data (), srcs, count, expected, len);
+}
+
+// dsts[j] += c[j] * src for every j < count, tables[j] expanded from c[j]
+// Each block of src is loaded once and feeds all outputs.
+inline void mul_add_multi (const NibbleTable *tables, const Element *src, Element *const *dsts, int count, size_t len)
+{
+  using namespace bulk_impl;
+  const unsigned char *s = bytes (src);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; i + 32 <= len; i += 32)
+    {
+      __m128i x0 = load (s + i);
+      __m128i x1 = load (s + i + 16);
+      for (int j = 0; j < count; j++)
+        {
+          unsigned char *d = bytes (dsts[j]) + i;
+          __m128i table_low = load (tables[j].low);
+          __m128i table_high = load (tables[j].high);
+          store (d, _mm_xor_si128 (load (d), mul_block (table_low, table_high, x0)));
+          store (d + 16, _mm_xor_si128 (load (d + 16), mul_block (table_low, table_high, x1)));
+        }
+    }
+#endif
+  for (; i < len; i++)
+    for (int j = 0; j < count; j++)
+      bytes (dsts[j])[i] ^= mul_byte (tables[j], s[i]);
+}
+
+// dsts[j] += coefs[j] * src for every j < count
+inline void mul_add_multi (const Element *coefs, const Element *src, Element *const *dsts, int count, size_t len)
+{
+  mul_add_multi (make_nibble_tables (coefs, count).data (), src, dsts, count, len);
+}
+
+#ifdef __SSSE3__
+namespace bulk_impl
+{
+// dot_product_multi over whole 32-byte blocks for a compile-time number of outputs,
+// so the accumulators stay in registers. Returns the number of bytes processed.
+template <int outputs>
+size_t dot_product_group (const NibbleTable *tables, const Element *const *srcs, int count,
+                          Element *const *dsts, size_t len, bool accumulate)
+{
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32)
+    {
+      __m128i acc[2 * outputs];
+      for (int o = 0; o < outputs; o++)
+        {
+          acc[2 * o] = accumulate ? load (bytes (dsts[o]) + i) : _mm_setzero_si128 ();
+          acc[2 * o + 1] = accumulate ? load (bytes (dsts[o]) + i + 16) : _mm_setzero_si128 ();
+        }
+
+      for (int j = 0; j < count; j++)
+        {
+          const unsigned char *s = bytes (srcs[j]) + i;
+          __m128i x0 = load (s);
+          __m128i x1 = load (s + 16);
+          for (int o = 0; o < outputs; o++)
+            {
+              const NibbleTable &table = tables[static_cast<size_t> (o) * count + j];
+              __m128i table_low = load (table.low);
+              __m128i table_high = load (table.high);
+              acc[2 * o] = _mm_xor_si128 (acc[2 * o], mul_block (table_low, table_high, x0));
+              acc[2 * o + 1] = _mm_xor_si128 (acc[2 * o + 1], mul_block (table_low, table_high, x1));
+            }
+        }
+
+      for (int o = 0; o < outputs; o++)
+        {
+          store (bytes (dsts[o]) + i, acc[2 * o]);
+          store (bytes (dsts[o]) + i + 16, acc[2 * o + 1]);
+        }
+    }
+  return i;
+}
+} //namespace bulk_impl
+#endif
+
+// dsts[o] = sum over j of c[o][j] * srcs[j] for o < outputs, with tables[o * count + j] expanded from c[o][j],
+// or dsts[o] += that sum with accumulate. Tables are expanded by the caller, so they can be reused across calls.
+inline void dot_product_multi (const NibbleTable *tables, const Element *const *srcs, int count,
+                               Element *const *dsts, int outputs, size_t len, bool accumulate = false)
+{
+  using namespace bulk_impl;
+  size_t i = 0;
+#ifdef __SSSE3__
+  // outputs are processed four at a time, a source block is loaded once per group
+  for (int first = 0; first < outputs; first += 4)
+    {
+      const NibbleTable *group_tables = tables + static_cast<size_t> (first) * count;
+      switch (std::min (4, outputs - first))
+        {
+        case 1: i = dot_product_group<1> (group_tables, srcs, count, dsts + first, len, accumulate); break;
+        case 2: i = dot_product_group<2> (group_tables, srcs, count, dsts + first, len, accumulate); break;
+        case 3: i = dot_product_group<3> (group_tables, srcs, count, dsts + first, len, accumulate); break;
+        default: i = dot_product_group<4> (group_tables, srcs, count, dsts + first, len, accumulate); break;
+        }
+    }
+#endif
+  for (; i < len; i++)
+    for (int o = 0; o < outputs; o++)
+      {
+        unsigned char acc = accumulate ? bytes (dsts[o])[i] : 0;
+        for (int j = 0; j < count; j++)
+          acc ^= mul_byte (tables[static_cast<size_t> (o) * count + j], bytes (srcs[j])[i]);
+        bytes (dsts[o])[i] = acc;
+      }
+}
+
+// dsts[o] (+)= sum over j of (o, j) * srcs[j]: tables.cols () sources, tables.rows () outputs
+inline void dot_product_multi (const Tables &tables, const Element *const *srcs, Element *const *dsts, size_t len,
+                               bool accumulate = false)
+{
+  dot_product_multi (tables.row (0), srcs, tables.cols (), dsts, tables.rows (), len, accumulate);
+}
+
+// dot_product_multi with tables[o * count + j] expanded from c[o][j], also returning the CRC32C
+// of every source in src_crcs and of every result in dst_crcs.
+// Checksums are taken from the blocks already loaded for the multiplication, so memory is read once.
+inline void dot_product_multi_crc (const NibbleTable *tables, const Element *const *srcs, int count,
+                                   Element *const *dsts, int outputs, size_t len,
+                                   uint32_t *src_crcs, uint32_t *dst_crcs)
+{
+  using namespace bulk_impl;
+  for (int j = 0; j < count; j++)
+    src_crcs[j] = crc32c_init;
+  for (int o = 0; o < outputs; o++)
+    dst_crcs[o] = crc32c_init;
+
+  size_t i = 0;
+#ifdef __SSSE3__
+  // at most group_size accumulators live at once, the sources are checksummed by the first group only
+  const int group_size = 8;
+  int groups = std::max (1, (outputs + group_size - 1) / group_size);
+  for (; i + 16 <= len; i += 16)
+    for (int g = 0; g < groups; g++)
+      {
+        int first = g * group_size;
+        int group = std::min (group_size, outputs - first);
+        __m128i acc[group_size];
+        for (int o = 0; o < group; o++)
+          acc[o] = _mm_setzero_si128 ();
+
+        for (int j = 0; j < count; j++)
+          {
+            __m128i x = load (bytes (srcs[j]) + i);
+            if (first == 0)
+              src_crcs[j] = crc_block (src_crcs[j], x);
+
+            for (int o = 0; o < group; o++)
+              {
+                const NibbleTable &table = tables[static_cast<size_t> (first + o) * count + j];
+                acc[o] = _mm_xor_si128 (acc[o], mul_block (load (table.low), load (table.high), x));
+              }
+          }
+
+        for (int o = 0; o < group; o++)
+          {
+            store (bytes (dsts[first + o]) + i, acc[o]);
+            dst_crcs[first + o] = crc_block (dst_crcs[first + o], acc[o]);
+          }
+      }
+#endif
+  for (; i < len; i++)
+    {
+      for (int j = 0; j < count; j++)
+        src_crcs[j] = crc32c_update_u8 (src_crcs[j], bytes (srcs[j])[i]);
+
+      for (int o = 0; o < outputs; o++)
+        {
+          unsigned char acc = 0;
+          for (int j = 0; j < count; j++)
+            acc ^= mul_byte (tables[static_cast<size_t> (o) * count + j], bytes (srcs[j])[i]);
+          bytes (dsts[o])[i] = acc;
+          dst_crcs[o] = crc32c_update_u8 (dst_crcs[o], acc);
+        }
+    }
+
+  for (int j = 0; j < count; j++)
+    src_crcs[j] = crc32c_final (src_crcs[j]);
+  for (int o = 0; o < outputs; o++)
+    dst_crcs[o] = crc32c_final (dst_crcs[o]);
+}
+
+// dsts[o] = coefs[o * count + 0] * srcs[0] + ... + coefs[o * count + count - 1] * srcs[count - 1] for o < outputs,
+// with the CRC32C of every source and every result
+inline void dot_product_multi_crc (const Element *coefs, const Element *const *srcs, int count,
+                                   Element *const *dsts, int outputs, size_t len,
+                                   uint32_t *src_crcs, uint32_t *dst_crcs)
+{
+  dot_product_multi_crc (make_nibble_tables (coefs, static_cast<size_t> (outputs) * count).data (), srcs, count,
+                         dsts, outputs, len, src_crcs, dst_crcs);
+}
+
+// mul_add_multi that also returns the CRC32C of src in src_crc and of every updated dsts[j] in dst_crcs.
+inline void mul_add_multi_crc (const NibbleTable *tables, const Element *src, Element *const *dsts, int count,
+                               size_t len, uint32_t *src_crc, uint32_t *dst_crcs)
+{
+  using namespace bulk_impl;
+  uint32_t src_state = crc32c_init;
+  for (int j = 0; j < count; j++)
+    dst_crcs[j] = crc32c_init;
+
+  const unsigned char *s = bytes (src);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i x = load (s + i);
+      src_state = crc_block (src_state, x);
+      for (int j = 0; j < count; j++)
+        {
+          unsigned char *d = bytes (dsts[j]) + i;
+          __m128i result = _mm_xor_si128 (load (d), mul_block (load (tables[j].low), load (tables[j].high), x));
+          store (d, result);
+          dst_crcs[j] = crc_block (dst_crcs[j], result);
+        }
+    }
+#endif
+  for (; i < len; i++)
+    {
+      src_state = crc32c_update_u8 (src_state, s[i]);
+      for (int j = 0; j < count; j++)
+        {
+          unsigned char &d = bytes (dsts[j])[i];
+          d ^= mul_byte (tables[j], s[i]);
+          dst_crcs[j] = crc32c_update_u8 (dst_crcs[j], d);
+        }
+    }
+
+  *src_crc = crc32c_final (src_state);
+  for (int j = 0; j < count; j++)
+    dst_crcs[j] = crc32c_final (dst_crcs[j]);
+}
+
+inline void mul_add_multi_crc (const Element *coefs, const Element *src, Element *const *dsts, int count, size_t len,
+                               uint32_t *src_crc, uint32_t *dst_crcs)
+{
+  mul_add_multi_crc (make_nibble_tables (coefs, count).data (), src, dsts, count, len, src_crc, dst_crcs);
+}
+
+} //namespace GF256
+
+#endif // BULK_HPP
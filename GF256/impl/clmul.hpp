@@ -0,0 +1,239 @@
+#ifndef CLMUL_HPP
+#define CLMUL_HPP
+
+#include "bulk.hpp"
+
+#include <cstdint>
+
+#if defined (__GNUC__) && defined (__x86_64__)
+#include <immintrin.h>
+#define GF256_CLMUL_X86 1
+#endif
+
+namespace GF256
+{
+
+// Table-free bulk multiplication by carry-less multiply. Bytes are widened to 16-bit lanes, so one
+// 64x64 PCLMULQDQ yields four independent 15-bit products, and products of a dot product are summed
+// unreduced before a single Barrett reduction per block. A coefficient costs one byte instead of the
+// 32 of a NibbleTable, which pays off once the tables of a large matrix no longer fit in L1.
+enum class ClmulKernel
+{
+  none,    // no carry-less multiply, the table kernels of bulk.hpp are used
+  pclmul,  // PCLMULQDQ, 16 bytes at a time
+  vpclmul  // VPCLMULQDQ on AVX-512 registers, 64 bytes at a time
+};
+
+namespace clmul_impl
+{
+inline constexpr unsigned polynomial = 0x1c3;
+
+// floor (x^16 / polynomial) over GF(2)
+inline constexpr unsigned barrett_mu = []
+{
+  unsigned remainder = 1u << 16;
+  unsigned quotient = 0;
+  for (int bit = 16; bit >= 8; bit--)
+    if (remainder & (1u << bit))
+      {
+        quotient |= 1u << (bit - 8);
+        remainder ^= polynomial << (bit - 8);
+      }
+  return quotient;
+} ();
+
+static_assert ((Element (static_cast<unsigned char> (0x80)) * Element (static_cast<unsigned char> (2))).additive_rep ()
+               == (polynomial & 0xff), "the reduction constants are written for the 0x1c3 polynomial");
+
+#ifdef GF256_CLMUL_X86
+// The AVX-512 code uses zero-masked intrinsics where GCC 12 warns about the undefined
+// pass-through operand of the unmasked ones.
+
+// Products of the four 16-bit lanes of each qword of v with the polynomial in the low qword of k.
+__attribute__ ((target ("pclmul,sse4.1")))
+inline __m128i clmul_lanes (__m128i v, __m128i k)
+{
+  return _mm_unpacklo_epi64 (_mm_clmulepi64_si128 (v, k, 0x00), _mm_clmulepi64_si128 (v, k, 0x01));
+}
+
+// Barrett reduction of 16-bit lanes holding polynomials of degree < 15.
+__attribute__ ((target ("pclmul,sse4.1")))
+inline __m128i reduce_lanes (__m128i p)
+{
+  const __m128i mu = _mm_cvtsi32_si128 (static_cast<int> (barrett_mu));
+  const __m128i poly = _mm_cvtsi32_si128 (static_cast<int> (polynomial));
+  __m128i q = _mm_srli_epi16 (clmul_lanes (_mm_srli_epi16 (p, 8), mu), 8);
+  return _mm_xor_si128 (p, clmul_lanes (q, poly));
+}
+
+template <int outputs>
+__attribute__ ((target ("pclmul,sse4.1")))
+size_t dot_product_group_pclmul (const Element *coefs, const Element *const *srcs, int count,
+                                 Element *const *dsts, size_t len)
+{
+  using namespace bulk_impl;
+  const __m128i zero = _mm_setzero_si128 ();
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i acc[2 * outputs];
+      for (int o = 0; o < 2 * outputs; o++)
+        acc[o] = zero;
+
+      for (int j = 0; j < count; j++)
+        {
+          __m128i x = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (bytes (srcs[j]) + i));
+          __m128i low = _mm_unpacklo_epi8 (x, zero);
+          __m128i high = _mm_unpackhi_epi8 (x, zero);
+          for (int o = 0; o < outputs; o++)
+            {
+              __m128i k = _mm_cvtsi32_si128 (coefs[o * count + j].additive_rep ());
+              acc[2 * o] = _mm_xor_si128 (acc[2 * o], clmul_lanes (low, k));
+              acc[2 * o + 1] = _mm_xor_si128 (acc[2 * o + 1], clmul_lanes (high, k));
+            }
+        }
+
+      for (int o = 0; o < outputs; o++)
+        {
+          __m128i result = _mm_packus_epi16 (reduce_lanes (acc[2 * o]), reduce_lanes (acc[2 * o + 1]));
+          _mm_storeu_si128 (reinterpret_cast<__m128i *> (bytes (dsts[o]) + i), result);
+        }
+    }
+  return i;
+}
+
+__attribute__ ((target ("avx512f,avx512bw,vpclmulqdq")))
+inline __m512i clmul_lanes (__m512i v, __m512i k)
+{
+  return _mm512_maskz_unpacklo_epi64 (0xff, _mm512_clmulepi64_epi128 (v, k, 0x00), _mm512_clmulepi64_epi128 (v, k, 0x01));
+}
+
+__attribute__ ((target ("avx512f,avx512bw,vpclmulqdq")))
+inline __m512i reduce_lanes (__m512i p)
+{
+  const __m512i mu = _mm512_set1_epi64 (barrett_mu);
+  const __m512i poly = _mm512_set1_epi64 (polynomial);
+  __m512i q = _mm512_srli_epi16 (clmul_lanes (_mm512_srli_epi16 (p, 8), mu), 8);
+  return _mm512_xor_si512 (p, clmul_lanes (q, poly));
+}
+
+template <int outputs>
+__attribute__ ((target ("avx512f,avx512bw,vpclmulqdq")))
+size_t dot_product_group_vpclmul (const Element *coefs, const Element *const *srcs, int count,
+                                  Element *const *dsts, size_t len)
+{
+  using namespace bulk_impl;
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64)
+    {
+      __m512i acc[2 * outputs];
+      for (int o = 0; o < 2 * outputs; o++)
+        acc[o] = _mm512_setzero_si512 ();
+
+      for (int j = 0; j < count; j++)
+        {
+          __m512i x = _mm512_loadu_si512 (bytes (srcs[j]) + i);
+          __m512i low = _mm512_cvtepu8_epi16 (_mm512_maskz_extracti64x4_epi64 (0xf, x, 0));
+          __m512i high = _mm512_cvtepu8_epi16 (_mm512_maskz_extracti64x4_epi64 (0xf, x, 1));
+          for (int o = 0; o < outputs; o++)
+            {
+              __m512i k = _mm512_set1_epi64 (coefs[o * count + j].additive_rep ());
+              acc[2 * o] = _mm512_xor_si512 (acc[2 * o], clmul_lanes (low, k));
+              acc[2 * o + 1] = _mm512_xor_si512 (acc[2 * o + 1], clmul_lanes (high, k));
+            }
+        }
+
+      for (int o = 0; o < outputs; o++)
+        {
+          __m256i low = _mm512_maskz_cvtepi16_epi8 (~0u, reduce_lanes (acc[2 * o]));
+          __m256i high = _mm512_maskz_cvtepi16_epi8 (~0u, reduce_lanes (acc[2 * o + 1]));
+          _mm256_storeu_si256 (reinterpret_cast<__m256i *> (bytes (dsts[o]) + i), low);
+          _mm256_storeu_si256 (reinterpret_cast<__m256i *> (bytes (dsts[o]) + i + 32), high);
+        }
+    }
+  return i;
+}
+#endif
+} //namespace clmul_impl
+
+// Widest carry-less multiply the running CPU supports, detected once.
+inline ClmulKernel best_clmul_kernel ()
+{
+#ifdef GF256_CLMUL_X86
+  static const ClmulKernel kernel =
+      __builtin_cpu_supports ("vpclmulqdq") && __builtin_cpu_supports ("avx512bw") ? ClmulKernel::vpclmul
+      : __builtin_cpu_supports ("pclmul") && __builtin_cpu_supports ("sse4.1")     ? ClmulKernel::pclmul
+                                                                                     : ClmulKernel::none;
+  return kernel;
+#else
+  return ClmulKernel::none;
+#endif
+}
+
+inline bool clmul_kernel_supported (ClmulKernel kernel)
+{
+  return kernel <= best_clmul_kernel ();
+}
+
+// dot_product_multi taking the coefficients themselves, coefs[o * count + j], instead of NibbleTables.
+// An unsupported kernel is a programmer error.
+inline void clmul_dot_product_multi (const Element *coefs, const Element *const *srcs, int count,
+                                     Element *const *dsts, int outputs, size_t len,
+                                     ClmulKernel kernel = best_clmul_kernel ())
+{
+  using namespace clmul_impl;
+  if (!clmul_kernel_supported (kernel))
+    std::terminate (); // the CPU lacks the instructions of this kernel
+
+  size_t done = 0;
+#ifdef GF256_CLMUL_X86
+  for (int first = 0; first < outputs && kernel != ClmulKernel::none; first += 4)
+    {
+      const Element *group_coefs = coefs + static_cast<size_t> (first) * count;
+      int group = std::min (4, outputs - first);
+      if (kernel == ClmulKernel::vpclmul)
+        switch (group)
+          {
+          case 1: done = dot_product_group_vpclmul<1> (group_coefs, srcs, count, dsts + first, len); break;
+          case 2: done = dot_product_group_vpclmul<2> (group_coefs, srcs, count, dsts + first, len); break;
+          case 3: done = dot_product_group_vpclmul<3> (group_coefs, srcs, count, dsts + first, len); break;
+          default: done = dot_product_group_vpclmul<4> (group_coefs, srcs, count, dsts + first, len); break;
+          }
+      else
+        switch (group)
+          {
+          case 1: done = dot_product_group_pclmul<1> (group_coefs, srcs, count, dsts + first, len); break;
+          case 2: done = dot_product_group_pclmul<2> (group_coefs, srcs, count, dsts + first, len); break;
+          case 3: done = dot_product_group_pclmul<3> (group_coefs, srcs, count, dsts + first, len); break;
+          default: done = dot_product_group_pclmul<4> (group_coefs, srcs, count, dsts + first, len); break;
+          }
+    }
+#endif
+  if (done == len)
+    return;
+
+  std::vector<const Element *> src_tails (count);
+  for (int j = 0; j < count; j++)
+    src_tails[j] = srcs[j] + done;
+
+  for (int o = 0; o < outputs; o++)
+    dot_product (coefs + static_cast<size_t> (o) * count, src_tails.data (), count, dsts[o] + done, len - done);
+}
+
+// dst = sum of coefs[j] * srcs[j]
+inline void clmul_dot_product (const Element *coefs, const Element *const *srcs, int count, Element *dst, size_t len,
+                               ClmulKernel kernel = best_clmul_kernel ())
+{
+  clmul_dot_product_multi (coefs, srcs, count, &dst, 1, len, kernel);
+}
+
+// dst = coef * src
+inline void clmul_mul_region (Element coef, const Element *src, Element *dst, size_t len,
+                              ClmulKernel kernel = best_clmul_kernel ())
+{
+  clmul_dot_product_multi (&coef, &src, 1, &dst, 1, len, kernel);
+}
+
+} //namespace GF256
+
+#endif // CLMUL_HPP
@@ -0,0 +1,82 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace GF256
+{
+
+// CRC32C (Castagnoli, reflected polynomial 0x82F63B78), the checksum of the SSE4.2 crc32 instruction.
+// crc32c_update works on the raw register: start from crc32c_init and finish with crc32c_final.
+inline constexpr uint32_t crc32c_init = 0xffffffffu;
+
+inline constexpr uint32_t crc32c_final (uint32_t state)
+{
+  return ~state;
+}
+
+inline constexpr std::array<uint32_t, 256> make_crc32c_table ()
+{
+  std::array<uint32_t, 256> table {};
+  for (uint32_t i = 0; i < 256; i++)
+    {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78u : 0);
+      table[i] = crc;
+    }
+  return table;
+}
+
+inline constexpr std::array<uint32_t, 256> crc32c_table = make_crc32c_table ();
+
+inline uint32_t crc32c_update_u8 (uint32_t state, unsigned char byte)
+{
+#ifdef __SSE4_2__
+  return _mm_crc32_u8 (state, byte);
+#else
+  return (state >> 8) ^ crc32c_table[(state ^ byte) & 0xff];
+#endif
+}
+
+inline uint32_t crc32c_update_u64 (uint32_t state, uint64_t word)
+{
+#ifdef __SSE4_2__
+  return static_cast<uint32_t> (_mm_crc32_u64 (state, word));
+#else
+  for (int i = 0; i < 8; i++)
+    state = crc32c_update_u8 (state, static_cast<unsigned char> (word >> (8 * i)));
+  return state;
+#endif
+}
+
+inline uint32_t crc32c_update (uint32_t state, const void *data, size_t len)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *> (data);
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8)
+    {
+      uint64_t word;
+      memcpy (&word, bytes + i, 8);
+      state = crc32c_update_u64 (state, word);
+    }
+  for (; i < len; i++)
+    state = crc32c_update_u8 (state, bytes[i]);
+  return state;
+}
+
+inline uint32_t crc32c (const void *data, size_t len)
+{
+  return crc32c_final (crc32c_update (crc32c_init, data, len));
+}
+
+} //namespace GF256
+
+#endif // CRC32C_HPP
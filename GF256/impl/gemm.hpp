@@ -0,0 +1,188 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include "bulk.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace GF256
+{
+
+// Tile sizes of gemm, in the manner of GotoBLAS/BLIS: the micro-kernel keeps 4 rows x 32 bytes of C in
+// registers, the 4 x kc tables it multiplies with stay in L1, the kc x nc panel of B it streams stays in L2,
+// and a thread owns an mc x nc tile of C at a time.
+struct GemmBlocking
+{
+  int mc = 64;        // rows of C per tile
+  int kc = 128;       // rows of B per panel, 4 * kc NibbleTables must fit in L1
+  size_t nc = 4096;   // columns per tile, kc * nc bytes of B must fit in L2
+};
+
+namespace gemm_impl
+{
+const int mr = 4; // rows of C per micro-kernel call
+
+// Coefficients of A expanded into NibbleTables, rows grouped by mr: group g holds its k columns one after
+// the other, the mr tables of a column together, so the micro-kernel reads them in order.
+inline std::vector<NibbleTable> pack_a (const Element *a, size_t lda, int m, int k)
+{
+  std::vector<NibbleTable> packed (static_cast<size_t> (m) * k);
+  size_t next = 0;
+  for (int first = 0; first < m; first += mr)
+    {
+      int rows = std::min (mr, m - first);
+      for (int j = 0; j < k; j++)
+        for (int o = 0; o < rows; o++)
+          packed[next++] = make_nibble_table (a[(first + o) * lda + j]);
+    }
+  return packed;
+}
+
+// dsts[o][offset, offset + len) (+)= sum over j < kc of A (o, j) * srcs[j], panel[j * rows + o] holding A (o, j)
+template <int rows>
+void micro_kernel (const NibbleTable *panel, const Element *const *srcs, int kc,
+                   Element *const *dsts, size_t offset, size_t len, bool accumulate)
+{
+  using namespace bulk_impl;
+  size_t i = offset;
+  size_t end = offset + len;
+#ifdef __SSSE3__
+  for (; i + 32 <= end; i += 32)
+    {
+      __m128i acc[2 * rows];
+      for (int o = 0; o < rows; o++)
+        {
+          acc[2 * o] = accumulate ? load (bytes (dsts[o]) + i) : _mm_setzero_si128 ();
+          acc[2 * o + 1] = accumulate ? load (bytes (dsts[o]) + i + 16) : _mm_setzero_si128 ();
+        }
+
+      for (int j = 0; j < kc; j++)
+        {
+          const unsigned char *s = bytes (srcs[j]) + i;
+          __m128i x0 = load (s);
+          __m128i x1 = load (s + 16);
+          for (int o = 0; o < rows; o++)
+            {
+              const NibbleTable &table = panel[j * rows + o];
+              __m128i table_low = load (table.low);
+              __m128i table_high = load (table.high);
+              acc[2 * o] = _mm_xor_si128 (acc[2 * o], mul_block (table_low, table_high, x0));
+              acc[2 * o + 1] = _mm_xor_si128 (acc[2 * o + 1], mul_block (table_low, table_high, x1));
+            }
+        }
+
+      for (int o = 0; o < rows; o++)
+        {
+          store (bytes (dsts[o]) + i, acc[2 * o]);
+          store (bytes (dsts[o]) + i + 16, acc[2 * o + 1]);
+        }
+    }
+#endif
+  for (; i < end; i++)
+    for (int o = 0; o < rows; o++)
+      {
+        unsigned char acc = accumulate ? bytes (dsts[o])[i] : 0;
+        for (int j = 0; j < kc; j++)
+          acc ^= mul_byte (panel[j * rows + o], bytes (srcs[j])[i]);
+        bytes (dsts[o])[i] = acc;
+      }
+}
+
+inline void run_micro_kernel (int rows, const NibbleTable *panel, const Element *const *srcs, int kc,
+                              Element *const *dsts, size_t offset, size_t len, bool accumulate)
+{
+  switch (rows)
+    {
+    case 1: micro_kernel<1> (panel, srcs, kc, dsts, offset, len, accumulate); break;
+    case 2: micro_kernel<2> (panel, srcs, kc, dsts, offset, len, accumulate); break;
+    case 3: micro_kernel<3> (panel, srcs, kc, dsts, offset, len, accumulate); break;
+    default: micro_kernel<4> (panel, srcs, kc, dsts, offset, len, accumulate); break;
+    }
+}
+} //namespace gemm_impl
+
+// C = A * B, or C += A * B with accumulate, over GF256. A is m x k, row-major with leading dimension lda,
+// B is k rows of n Elements at b_rows[j] and C is m rows of n Elements at c_rows[i], so the rows of B can be
+// the data shards of a batch of stripes laid end to end. Tiles of C are shared out to threads, 0 threads
+// meaning one per hardware thread. C must not overlap A or B.
+inline void gemm (int m, int k, size_t n, const Element *a, size_t lda, const Element *const *b_rows,
+                  Element *const *c_rows, bool accumulate = false, int threads = 1, GemmBlocking blocking = {})
+{
+  using namespace gemm_impl;
+  if (m <= 0 || n == 0)
+    return;
+
+  if (k <= 0)
+    {
+      if (!accumulate)
+        for (int i = 0; i < m; i++)
+          std::fill (c_rows[i], c_rows[i] + n, zero_element ());
+      return;
+    }
+
+  std::vector<NibbleTable> packed = pack_a (a, lda, m, k);
+
+  const int mc = std::max (mr, blocking.mc / mr * mr);
+  const int kc = std::max (1, blocking.kc);
+  const size_t nc = std::max<size_t> (32, blocking.nc / 32 * 32);
+  const int row_tiles = (m + mc - 1) / mc;
+  const size_t col_tiles = (n + nc - 1) / nc;
+  const size_t tiles = row_tiles * col_tiles;
+
+  std::atomic<size_t> next_tile {0};
+  auto work = [&] ()
+  {
+    for (size_t tile = next_tile++; tile < tiles; tile = next_tile++)
+      {
+        int ic = static_cast<int> (tile % row_tiles) * mc;
+        size_t jc = tile / row_tiles * nc;
+        int rows = std::min (mc, m - ic);
+        size_t cols = std::min (nc, n - jc);
+
+        // B panels of kc rows, each streamed once per group of mr rows of the tile
+        for (int pc = 0; pc < k; pc += kc)
+          {
+            int depth = std::min (kc, k - pc);
+            for (int ir = ic; ir < ic + rows; ir += mr)
+              {
+                int group = std::min (mr, m - ir);
+                const NibbleTable *panel = packed.data () + static_cast<size_t> (ir) * k + static_cast<size_t> (pc) * group;
+                run_micro_kernel (group, panel, b_rows + pc, depth, c_rows + ir, jc, cols, accumulate || pc > 0);
+              }
+          }
+      }
+  };
+
+  if (threads <= 0)
+    threads = std::max (1u, std::thread::hardware_concurrency ());
+  threads = static_cast<int> (std::min<size_t> (threads, tiles));
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++)
+    workers.emplace_back (work);
+  work ();
+  for (auto &worker : workers)
+    worker.join ();
+}
+
+// gemm on row-major matrices with leading dimensions
+inline void gemm (int m, int k, size_t n, const Element *a, size_t lda, const Element *b, size_t ldb,
+                  Element *c, size_t ldc, bool accumulate = false, int threads = 1, GemmBlocking blocking = {})
+{
+  std::vector<const Element *> b_rows (k);
+  for (int j = 0; j < k; j++)
+    b_rows[j] = b + j * ldb;
+
+  std::vector<Element *> c_rows (m);
+  for (int i = 0; i < m; i++)
+    c_rows[i] = c + i * ldc;
+
+  gemm (m, k, n, a, lda, b_rows.data (), c_rows.data (), accumulate, threads, blocking);
+}
+
+} //namespace GF256
+
+#endif // GEMM_HPP
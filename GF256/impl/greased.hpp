@@ -0,0 +1,200 @@
+#ifndef GREASED_HPP
+#define GREASED_HPP
+
+#include "bulk.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace GF256
+{
+
+// "Four Russians" products and elimination, after M4RI and its GF(2^e) generalization M4RIE. All 256
+// multiples of a row are tabulated once (a Newton-John table), after which adding c * row to any number of
+// rows is a table lookup and an XOR, with no multiplication. Tables of `group` rows are used together, so
+// a row takes the contribution of four rows of the other operand in a single pass. Tabulating costs about
+// 256 row XORs per row, each far cheaper than a multiply-add, so this pays off once a table is shared by
+// about 128 rows.
+namespace greased_impl
+{
+const int group = 4;        // rows tabulated together
+const size_t width = 128;   // columns per table, group * 256 * width bytes stay in L2
+
+// table[c * width + i] = c * row[i] for every c, i < len <= width
+inline void make_table (const Element *row, size_t len, Element *table)
+{
+  using namespace bulk_impl;
+  unsigned char *t = bytes (table);
+  std::fill (t, t + len, 0);
+  std::copy (bytes (row), bytes (row) + len, t + width);
+
+  const Element x (static_cast<unsigned char> (2));
+  for (size_t c = 2; c < 256; c++)
+    {
+      size_t low = c & (~c + 1);
+      unsigned char *entry = t + c * width;
+      if (low == c)
+        {
+          mul_region (x, table + c / 2 * width, table + c * width, len);
+          continue;
+        }
+
+      // multiples are linear in c, c * row = low * row + (c - low) * row
+      const unsigned char *lhs = t + low * width;
+      const unsigned char *rhs = t + (c - low) * width;
+      size_t i = 0;
+#ifdef __SSSE3__
+      for (; i + 16 <= len; i += 16)
+        store (entry + i, _mm_xor_si128 (load (lhs + i), load (rhs + i)));
+#endif
+      for (; i < len; i++)
+        entry[i] = lhs[i] ^ rhs[i];
+    }
+}
+
+// dst += sum over t < rows of coefs[t] * row t, through the tables of the rows
+template <int rows>
+void add_multiples (const Element *tables, const unsigned char *coefs, Element *dst, size_t len)
+{
+  using namespace bulk_impl;
+  const unsigned char *entries[rows];
+  for (int t = 0; t < rows; t++)
+    entries[t] = bytes (tables) + (t * 256 + coefs[t]) * width;
+
+  unsigned char *d = bytes (dst);
+  size_t i = 0;
+#ifdef __SSSE3__
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i acc = load (d + i);
+      for (int t = 0; t < rows; t++)
+        acc = _mm_xor_si128 (acc, load (entries[t] + i));
+      store (d + i, acc);
+    }
+#endif
+  for (; i < len; i++)
+    {
+      unsigned char acc = d[i];
+      for (int t = 0; t < rows; t++)
+        acc ^= entries[t][i];
+      d[i] = acc;
+    }
+}
+
+inline void add_multiples (int rows, const Element *tables, const unsigned char *coefs, Element *dst, size_t len)
+{
+  switch (rows)
+    {
+    case 1: add_multiples<1> (tables, coefs, dst, len); break;
+    case 2: add_multiples<2> (tables, coefs, dst, len); break;
+    case 3: add_multiples<3> (tables, coefs, dst, len); break;
+    default: add_multiples<4> (tables, coefs, dst, len); break;
+    }
+}
+} //namespace greased_impl
+
+// C = A * B, or C += A * B with accumulate. A is m x k, B is k x n and C is m x n, all row-major with
+// leading dimensions. C must not overlap A or B. Faster than gemm from m = 128 on, the Matrix::greased_rows
+// threshold at which Matrix switches to it.
+inline void greased_multiply (int m, int k, size_t n, const Element *a, size_t lda, const Element *b, size_t ldb,
+                              Element *c, size_t ldc, bool accumulate = false)
+{
+  using namespace greased_impl;
+  if (!accumulate)
+    for (int i = 0; i < m; i++)
+      std::fill (c + i * ldc, c + i * ldc + n, zero_element ());
+
+  if (m <= 0 || k <= 0 || n == 0)
+    return;
+
+  // coefficients of A by groups of columns, so a group reads them in order
+  const int groups = (k + group - 1) / group;
+  std::vector<unsigned char> coefs (static_cast<size_t> (groups) * m * group);
+  for (int g = 0; g < groups; g++)
+    for (int i = 0; i < m; i++)
+      for (int t = 0; t < group && g * group + t < k; t++)
+        coefs[(static_cast<size_t> (g) * m + i) * group + t] = a[i * lda + g * group + t].additive_rep ();
+
+  // a strip of columns of C stays in cache while every group of rows of B is added to it
+  std::vector<Element> tables (group * 256 * width);
+  for (size_t col = 0; col < n; col += width)
+    {
+      size_t len = std::min (width, n - col);
+      for (int g = 0; g < groups; g++)
+        {
+          int rows = std::min (group, k - g * group);
+          for (int t = 0; t < rows; t++)
+            make_table (b + (g * group + t) * ldb + col, len, tables.data () + t * 256 * width);
+
+          const unsigned char *group_coefs = coefs.data () + static_cast<size_t> (g) * m * group;
+          for (int i = 0; i < m; i++)
+            add_multiples (rows, tables.data (), group_coefs + i * group, c + i * ldc + col, len);
+        }
+    }
+}
+
+// Gauss-Jordan elimination of the n x cols matrix at a (cols >= n, leading dimension lda) until its
+// left n x n block is the identity, so [M | I] turns into [I | M^-1]. Pivots are found `group` columns at
+// a time, and the rows are then cleared of all of them at once through the tables of the pivot rows.
+// Returns false, leaving a in an unspecified state, when the left block is singular.
+inline bool greased_eliminate (Element *a, int n, size_t cols, size_t lda)
+{
+  using namespace greased_impl;
+  auto row = [&] (int r) {return a + r * lda;};
+
+  std::vector<Element> tables (group * 256 * width);
+  std::vector<unsigned char> coefs (static_cast<size_t> (n) * group);
+  for (int first = 0; first < n; first += group)
+    {
+      int rows = std::min (group, n - first);
+
+      // pivots of the block, kept reduced against each other; rows are reduced lazily as they are searched
+      for (int t = 0; t < rows; t++)
+        {
+          int col = first + t;
+          int pivot = col;
+          for (; pivot < n; pivot++)
+            {
+              Element value = row (pivot)[col];
+              for (int s = 0; s < t; s++)
+                value += row (pivot)[first + s] * row (first + s)[col];
+              if (value != zero_element ())
+                break;
+            }
+
+          if (pivot == n)
+            return false;
+
+          if (pivot != col)
+            std::swap_ranges (row (pivot) + first, row (pivot) + cols, row (col) + first);
+
+          for (int s = 0; s < t; s++)
+            mul_add_region (row (col)[first + s], row (first + s) + first, row (col) + first, cols - first);
+
+          mul_region (row (col)[col].inv (), row (col) + first, row (col) + first, cols - first);
+          for (int s = 0; s < t; s++)
+            mul_add_region (row (first + s)[col], row (col) + first, row (first + s) + first, cols - first);
+        }
+
+      for (int r = 0; r < n; r++)
+        for (int t = 0; t < rows; t++)
+          coefs[r * group + t] = r >= first && r < first + rows ? 0 : row (r)[first + t].additive_rep ();
+
+      for (size_t col = first; col < cols; col += width)
+        {
+          size_t len = std::min (width, cols - col);
+          for (int t = 0; t < rows; t++)
+            make_table (row (first + t) + col, len, tables.data () + t * 256 * width);
+
+          for (int r = 0; r < n; r++)
+            if (r < first || r >= first + rows)
+              add_multiples (rows, tables.data (), coefs.data () + r * group, row (r) + col, len);
+        }
+    }
+
+  return true;
+}
+
+} //namespace GF256
+
+#endif // GREASED_HPP
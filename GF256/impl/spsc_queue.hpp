@@ -0,0 +1,100 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace GF256
+{
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. A blocked push or pop
+// yields for a few tries, then sleeps in std::atomic::wait until the other side moves, so an idle stage
+// does not burn a core.
+template <class T>
+class SpscQueue
+{
+  static const int spin_tries = 64;
+
+  std::vector<T> m_slots;
+  size_t m_mask = 0;
+  alignas (64) std::atomic<size_t> m_head {0}; // next slot to pop, owned by the consumer
+  alignas (64) std::atomic<size_t> m_tail {0}; // next slot to push, owned by the producer
+
+public:
+  // capacity is rounded up to a power of two
+  explicit SpscQueue (size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+
+    m_slots.resize (size);
+    m_mask = size - 1;
+  }
+
+  bool try_push (const T &value)
+  {
+    size_t tail = m_tail.load (std::memory_order_relaxed);
+    if (tail - m_head.load (std::memory_order_acquire) == m_slots.size ())
+      return false;
+
+    m_slots[tail & m_mask] = value;
+    m_tail.store (tail + 1, std::memory_order_release);
+    m_tail.notify_one ();
+    return true;
+  }
+
+  bool try_pop (T &value)
+  {
+    size_t head = m_head.load (std::memory_order_relaxed);
+    if (head == m_tail.load (std::memory_order_acquire))
+      return false;
+
+    value = m_slots[head & m_mask];
+    m_head.store (head + 1, std::memory_order_release);
+    m_head.notify_one ();
+    return true;
+  }
+
+  void push (const T &value)
+  {
+    for (int tries = 0; !try_push (value); tries++)
+      {
+        if (tries < spin_tries)
+          {
+            std::this_thread::yield ();
+            continue;
+          }
+
+        // sleeps unless the consumer popped since the queue was seen full
+        size_t head = m_head.load (std::memory_order_acquire);
+        if (m_tail.load (std::memory_order_relaxed) - head == m_slots.size ())
+          m_head.wait (head, std::memory_order_acquire);
+      }
+  }
+
+  T pop ()
+  {
+    T value;
+    for (int tries = 0; !try_pop (value); tries++)
+      {
+        if (tries < spin_tries)
+          {
+            std::this_thread::yield ();
+            continue;
+          }
+
+        // sleeps unless the producer pushed since the queue was seen empty
+        size_t tail = m_tail.load (std::memory_order_acquire);
+        if (m_head.load (std::memory_order_relaxed) == tail)
+          m_tail.wait (tail, std::memory_order_acquire);
+      }
+    return value;
+  }
+};
+
+} //namespace GF256
+
+#endif // SPSC_QUEUE_HPP
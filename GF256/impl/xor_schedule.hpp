@@ -0,0 +1,146 @@
+#ifndef XOR_SCHEDULE_HPP
+#define XOR_SCHEDULE_HPP
+
+#include "bulk.hpp"
+
+#include <array>
+#include <vector>
+
+namespace GF256
+{
+
+// Multiplication by coef as a linear map of GF(2)^8: bit r of coef * x is the parity of x & rows[r].
+// Column c holds the bits of coef * 2^c, since x = sum of x_c * 2^c.
+inline constexpr std::array<unsigned char, 8> multiply_bitmatrix (Element coef)
+{
+  std::array<unsigned char, 8> rows {};
+  for (int c = 0; c < 8; c++)
+    {
+      unsigned char column = (coef * Element (static_cast<unsigned char> (1 << c))).additive_rep ();
+      for (int r = 0; r < 8; r++)
+        if (column & (1 << r))
+          rows[r] |= static_cast<unsigned char> (1 << c);
+    }
+  return rows;
+}
+
+// Straight-line XOR program computing outputs from inputs.
+// Symbols 0 .. inputs - 1 are inputs, inputs .. inputs + temps - 1 intermediate results
+// and inputs + temps .. inputs + temps + outputs - 1 outputs.
+struct XorSchedule
+{
+  struct Op
+  {
+    int dst;
+    int src;
+    bool copy; // dst = src instead of dst ^= src, dst = 0 when src is negative
+  };
+
+  int inputs = 0;
+  int temps = 0;
+  int outputs = 0;
+  std::vector<Op> ops;
+
+  int xor_count () const
+  {
+    int count = 0;
+    for (const Op &op : ops)
+      count += op.copy ? 0 : 1;
+    return count;
+  }
+};
+
+// rows[o] lists the inputs XORed into output o. With optimize, common pairs of symbols are factored
+// out greedily (Paar's algorithm): the pair shared by most rows becomes a temp, until no pair repeats.
+inline XorSchedule make_xor_schedule (int inputs, std::vector<std::vector<int>> rows, bool optimize)
+{
+  XorSchedule schedule;
+  schedule.inputs = inputs;
+  schedule.outputs = static_cast<int> (rows.size ());
+
+  std::vector<std::pair<int, int>> temps;
+  while (optimize)
+    {
+      int symbols = inputs + static_cast<int> (temps.size ());
+      std::vector<int> counts (static_cast<size_t> (symbols) * symbols, 0);
+      for (const std::vector<int> &row : rows)
+        for (size_t a = 0; a < row.size (); a++)
+          for (size_t b = a + 1; b < row.size (); b++)
+            counts[static_cast<size_t> (row[a]) * symbols + row[b]]++;
+
+      auto best = std::max_element (counts.begin (), counts.end ());
+      if (*best < 2)
+        break;
+
+      int first = static_cast<int> ((best - counts.begin ()) / symbols);
+      int second = static_cast<int> ((best - counts.begin ()) % symbols);
+      temps.push_back ({first, second});
+
+      // rows stay sorted, the new temp has the largest symbol
+      for (std::vector<int> &row : rows)
+        {
+          auto a = std::find (row.begin (), row.end (), first);
+          auto b = std::find (row.begin (), row.end (), second);
+          if (a == row.end () || b == row.end ())
+            continue;
+
+          row.erase (b);
+          row.erase (std::find (row.begin (), row.end (), first));
+          row.push_back (symbols);
+        }
+    }
+
+  schedule.temps = static_cast<int> (temps.size ());
+  for (size_t t = 0; t < temps.size (); t++)
+    {
+      int dst = inputs + static_cast<int> (t);
+      schedule.ops.push_back ({dst, temps[t].first, true});
+      schedule.ops.push_back ({dst, temps[t].second, false});
+    }
+
+  for (int o = 0; o < schedule.outputs; o++)
+    {
+      int dst = inputs + schedule.temps + o;
+      if (rows[o].empty ())
+        schedule.ops.push_back ({dst, -1, true});
+      for (size_t i = 0; i < rows[o].size (); i++)
+        schedule.ops.push_back ({dst, rows[o][i], i == 0});
+    }
+
+  return schedule;
+}
+
+// Bit-level schedule of dsts[o] = sum over j of coefs[o * count + j] * srcs[j] on bit-plane packets:
+// symbol 8 * j + c is bit plane c of source j, output 8 * o + r is bit plane r of destination o.
+inline XorSchedule make_xor_schedule (const Element *coefs, int count, int outputs, bool optimize)
+{
+  std::vector<std::vector<int>> rows (static_cast<size_t> (outputs) * 8);
+  for (int o = 0; o < outputs; o++)
+    for (int j = 0; j < count; j++)
+      {
+        std::array<unsigned char, 8> bits = multiply_bitmatrix (coefs[o * count + j]);
+        for (int r = 0; r < 8; r++)
+          for (int c = 0; c < 8; c++)
+            if (bits[r] & (1 << c))
+              rows[8 * o + r].push_back (8 * j + c);
+      }
+
+  return make_xor_schedule (8 * count, std::move (rows), optimize);
+}
+
+// Runs the schedule on packets of packet_size bytes. symbols holds inputs + temps + outputs pointers.
+inline void run_xor_schedule (const XorSchedule &schedule, Element *const *symbols, size_t packet_size)
+{
+  using namespace bulk_impl;
+  for (const XorSchedule::Op &op : schedule.ops)
+    if (!op.copy)
+      add_region (symbols[op.src], symbols[op.dst], packet_size);
+    else if (op.src >= 0)
+      memcpy (bytes (symbols[op.dst]), bytes (symbols[op.src]), packet_size);
+    else
+      memset (bytes (symbols[op.dst]), 0, packet_size);
+}
+
+} //namespace GF256
+
+#endif // XOR_SCHEDULE_HPP
@@ -0,0 +1,356 @@
+#include "file_modes.hpp"
+
+#include "GF256/ReedSolomon.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+// Every shard file starts with this header, the payload follows at offset sizeof (ShardHeader).
+struct ShardHeader
+{
+  char magic[8];          // "GF256SHD"
+  uint32_t version;
+  uint32_t polynomial;    // 0x1C3: x^8 + x^7 + x^6 + x + 1
+  uint32_t data_shards;
+  uint32_t parity_shards;
+  uint32_t shard_index;
+  uint32_t payload_crc;   // CRC32C of the payload
+  uint64_t file_size;     // size of the encoded file
+  uint64_t shard_len;     // payload size
+  char reserved[12];
+  uint32_t header_crc;    // CRC32C of the header bytes before it
+};
+
+static_assert (sizeof (ShardHeader) == 64, "shard header layout changed");
+
+const char shard_magic[8] = {'G', 'F', '2', '5', '6', 'S', 'H', 'D'};
+const uint32_t shard_version = 2;
+const uint32_t field_polynomial = 0x1c3;
+
+// Read-only or read-write shared mapping of a whole file.
+class MappedFile
+{
+  int m_fd = -1;
+  void *m_data = MAP_FAILED;
+  size_t m_size = 0;
+
+public:
+  MappedFile () {}
+  MappedFile (const MappedFile &) = delete;
+  MappedFile &operator = (const MappedFile &) = delete;
+
+  ~MappedFile ()
+  {
+    if (m_data != MAP_FAILED)
+      munmap (m_data, m_size);
+    if (m_fd >= 0)
+      close (m_fd);
+  }
+
+  bool open_read (const std::string &path)
+  {
+    m_fd = open (path.c_str (), O_RDONLY);
+    if (m_fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat (m_fd, &st) != 0)
+      return false;
+
+    m_size = static_cast<size_t> (st.st_size);
+    if (m_size == 0)
+      return true;
+
+    m_data = mmap (nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    return m_data != MAP_FAILED;
+  }
+
+  bool create (const std::string &path, size_t size)
+  {
+    m_fd = open (path.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0 || ftruncate (m_fd, static_cast<off_t> (size)) != 0)
+      return false;
+
+    m_size = size;
+    if (m_size == 0)
+      return true;
+
+    m_data = mmap (nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    return m_data != MAP_FAILED;
+  }
+
+  size_t size () const {return m_size;}
+
+  unsigned char *data () const
+  {
+    return m_data == MAP_FAILED ? nullptr : static_cast<unsigned char *> (m_data);
+  }
+
+  GF256::Element *payload () const
+  {
+    return reinterpret_cast<GF256::Element *> (data () + sizeof (ShardHeader));
+  }
+
+  ShardHeader *header () const
+  {
+    return reinterpret_cast<ShardHeader *> (data ());
+  }
+};
+
+uint32_t header_crc (const ShardHeader &header)
+{
+  return GF256::crc32c (&header, offsetof (ShardHeader, header_crc));
+}
+
+// Header fields a shard must share with the others of its stripe.
+struct Geometry
+{
+  uint32_t data_shards = 0;
+  uint32_t parity_shards = 0;
+  uint64_t file_size = 0;
+  uint64_t shard_len = 0;
+
+  explicit Geometry (const ShardHeader &header)
+    : data_shards (header.data_shards), parity_shards (header.parity_shards),
+      file_size (header.file_size), shard_len (header.shard_len) {}
+
+  bool operator == (const Geometry &other) const
+  {
+    return data_shards == other.data_shards && parity_shards == other.parity_shards
+           && file_size == other.file_size && shard_len == other.shard_len;
+  }
+};
+
+std::string shard_path (const std::string &dir, int index)
+{
+  char name[32];
+  snprintf (name, sizeof (name), "/shard.%03d", index);
+  return dir + name;
+}
+
+bool parse_int (const char *str, int &value)
+{
+  char *end = nullptr;
+  long parsed = strtol (str, &end, 10);
+  if (!*str || *end)
+    return false;
+
+  value = static_cast<int> (parsed);
+  return true;
+}
+
+} //namespace
+
+int GF256::run_encode_mode (int argc, char *argv[])
+{
+  int k = 0;
+  int m = 0;
+  if (argc != 6 || !parse_int (argv[3], k) || !parse_int (argv[4], m) || k <= 0 || m < 0 || k + m > 256)
+    {
+      printf ("Usage: GF256 encode <file> <k> <m> <output-dir>, k > 0, m >= 0, k + m <= 256\n");
+      return 1;
+    }
+
+  std::string out_dir = argv[5];
+  MappedFile input;
+  if (!input.open_read (argv[2]))
+    {
+      printf ("ERROR: cannot map %s\n", argv[2]);
+      return 1;
+    }
+
+  mkdir (out_dir.c_str (), 0755);
+
+  size_t shard_len = (input.size () + k - 1) / k;
+  std::vector<MappedFile> shards (k + m);
+  std::vector<Element *> payloads (k + m);
+  for (int i = 0; i < k + m; i++)
+    {
+      if (!shards[i].create (shard_path (out_dir, i), sizeof (ShardHeader) + shard_len))
+        {
+          printf ("ERROR: cannot create %s\n", shard_path (out_dir, i).c_str ());
+          return 1;
+        }
+      payloads[i] = shards[i].payload ();
+    }
+
+  // data shards are the input split in k pieces, the last one zero-padded by ftruncate
+  for (int i = 0; i < k; i++)
+    {
+      size_t begin = std::min (input.size (), i * shard_len);
+      size_t end = std::min (input.size (), (i + 1) * shard_len);
+      if (end > begin)
+        memcpy (payloads[i], input.data () + begin, end - begin);
+    }
+
+  ReedSolomon rs (k, m);
+  std::vector<uint32_t> crcs (k + m);
+  rs.encode (payloads.data (), payloads.data () + k, shard_len, crcs.data (), crcs.data () + k);
+
+  for (int i = 0; i < k + m; i++)
+    {
+      ShardHeader *header = shards[i].header ();
+      memcpy (header->magic, shard_magic, sizeof (shard_magic));
+      header->version = shard_version;
+      header->polynomial = field_polynomial;
+      header->data_shards = static_cast<uint32_t> (k);
+      header->parity_shards = static_cast<uint32_t> (m);
+      header->shard_index = static_cast<uint32_t> (i);
+      header->payload_crc = crcs[i];
+      header->file_size = input.size ();
+      header->shard_len = shard_len;
+      header->header_crc = header_crc (*header);
+    }
+
+  printf ("Encoded %zu bytes into %d + %d shards of %zu bytes in %s\n", input.size (), k, m, shard_len, out_dir.c_str ());
+  return 0;
+}
+
+int GF256::run_decode_mode (int argc, char *argv[])
+{
+  if (argc != 4)
+    {
+      printf ("Usage: GF256 decode <shard-dir> <output-file>\n");
+      return 1;
+    }
+
+  std::string in_dir = argv[2];
+  std::vector<MappedFile> shards (256);
+  std::vector<bool> valid (256, false);
+
+  // a header takes part in the vote only if it is intact and consistent with its own file
+  for (int i = 0; i < 256; i++)
+    {
+      MappedFile &shard = shards[i];
+      if (!shard.open_read (shard_path (in_dir, i)))
+        continue;
+
+      const ShardHeader *header = shard.header ();
+      valid[i] = shard.size () >= sizeof (ShardHeader)
+                 && memcmp (header->magic, shard_magic, sizeof (shard_magic)) == 0
+                 && header->version == shard_version
+                 && header->header_crc == header_crc (*header)
+                 && header->polynomial == field_polynomial
+                 && header->data_shards > 0
+                 && header->data_shards + header->parity_shards <= 256
+                 && header->shard_index == static_cast<uint32_t> (i)
+                 && shard.size () == sizeof (ShardHeader) + header->shard_len;
+
+      if (!valid[i])
+        printf ("WARNING: skipping shard %s with an invalid header\n", shard_path (in_dir, i).c_str ());
+    }
+
+  // the geometry most headers agree on, so no single damaged shard decides it
+  std::vector<std::pair<Geometry, int>> votes;
+  for (int i = 0; i < 256; i++)
+    if (valid[i])
+      {
+        Geometry geometry (*shards[i].header ());
+        auto it = std::find_if (votes.begin (), votes.end (), [&] (const auto &vote) {return vote.first == geometry;});
+        if (it == votes.end ())
+          votes.emplace_back (geometry, 1);
+        else
+          it->second++;
+      }
+
+  if (votes.empty ())
+    {
+      printf ("ERROR: no valid shards in %s\n", in_dir.c_str ());
+      return 1;
+    }
+
+  const Geometry reference = std::max_element (votes.begin (), votes.end (), [] (const auto &lhs, const auto &rhs)
+  {
+    return lhs.second < rhs.second;
+  })->first;
+
+  for (int i = 0; i < 256; i++)
+    if (valid[i])
+      {
+        const ShardHeader *header = shards[i].header ();
+        valid[i] = Geometry (*header) == reference && crc32c (shards[i].payload (), header->shard_len) == header->payload_crc;
+        if (!valid[i])
+          printf ("WARNING: skipping invalid shard %s\n", shard_path (in_dir, i).c_str ());
+      }
+
+  int k = static_cast<int> (reference.data_shards);
+  int m = static_cast<int> (reference.parity_shards);
+  size_t shard_len = reference.shard_len;
+  size_t file_size = reference.file_size;
+
+  std::vector<bool> present (k + m, false);
+  std::vector<const Element *> payloads (k + m, nullptr);
+  int present_count = 0;
+  for (int i = 0; i < k + m; i++)
+    if (valid[i])
+      {
+        present[i] = true;
+        payloads[i] = shards[i].payload ();
+        present_count++;
+      }
+
+  if (present_count < k)
+    {
+      printf ("ERROR: %d valid shards found, %d needed\n", present_count, k);
+      return 1;
+    }
+
+  MappedFile output;
+  if (!output.create (argv[3], file_size))
+    {
+      printf ("ERROR: cannot create %s\n", argv[3]);
+      return 1;
+    }
+
+  ReedSolomon rs (k, m);
+  std::vector<Element> tail;
+  for (int i = 0; i < k; i++)
+    {
+      size_t begin = std::min (file_size, i * shard_len);
+      size_t end = std::min (file_size, (i + 1) * shard_len);
+      if (end == begin)
+        continue;
+
+      Element *target = reinterpret_cast<Element *> (output.data () + begin);
+      if (present[i])
+        {
+          memcpy (target, payloads[i], end - begin);
+          continue;
+        }
+
+      // a lost data shard is decoded straight into the output, except for a short last piece
+      bool rebuilt = false;
+      if (end - begin == shard_len)
+        rebuilt = rs.reconstruct_range (payloads.data (), present, i, 0, shard_len, target);
+      else
+        {
+          tail.resize (shard_len);
+          rebuilt = rs.reconstruct_range (payloads.data (), present, i, 0, shard_len, tail.data ());
+          memcpy (target, tail.data (), end - begin);
+        }
+
+      if (!rebuilt)
+        {
+          printf ("ERROR: cannot rebuild data shard %d\n", i);
+          unlink (argv[3]);
+          return 1;
+        }
+    }
+
+  printf ("Decoded %zu bytes from %d of %d shards into %s\n", file_size, present_count, k + m, argv[3]);
+  return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef FILE_MODES_HPP
+#define FILE_MODES_HPP
+
+namespace GF256
+{
+// GF256 encode <file> <k> <m> <output-dir>
+int run_encode_mode (int argc, char *argv[]);
+// GF256 decode <shard-dir> <output-file>
+int run_decode_mode (int argc, char *argv[]);
+}
+
+#endif // FILE_MODES_HPP
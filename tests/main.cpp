@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cstring>
 
+#include "file_modes.hpp"
 #include "run_suits.hpp"
 
 int main (int argc, char *argv[])
@@ -9,7 +10,15 @@ int main (int argc, char *argv[])
                              "OPTIONS:\n"
                              "-h\tPrint implementation details\n"
                              "-t\tRun test suit\n"
-                             "-b\tRun benchmark suit";
+                             "-b\tRun benchmark suit\n"
+                             "encode <file> <k> <m> <output-dir>\tSplit a file into k data and m parity shard files\n"
+                             "decode <shard-dir> <output-file>\tRestore a file from any k valid shard files";
+  if (argc >= 2 && strcmp (argv[1], "encode") == 0)
+    return GF256::run_encode_mode (argc, argv);
+
+  if (argc >= 2 && strcmp (argv[1], "decode") == 0)
+    return GF256::run_decode_mode (argc, argv);
+
   if (argc != 2)
     {
       printf ("%s\n", usage_string);
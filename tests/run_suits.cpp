@@ -1,16 +1,39 @@
 #include "run_suits.hpp"
+#include "file_modes.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <chrono>
 #include <random>
 #include <cmath>
+#include <ctime>
 
 #include "gf256-3rd-party/gf256.h"
 
+#include "GF256/AsyncCodec.hpp"
+#include "GF256/BitmatrixCodec.hpp"
+#include "GF256/Buffer.hpp"
+#include "GF256/ConstantTime.hpp"
+#include "GF256/FixedReedSolomon.hpp"
 #include "GF256/GF256.hpp"
+#include "GF256/JitEncoder.hpp"
+#include "GF256/LRC.hpp"
+#include "GF256/MSR.hpp"
+#include "GF256/ReedSolomon.hpp"
+#include "GF256/ShardIO.hpp"
+#include "GF256/SparseMatrix.hpp"
+#include "GF256/Vec.hpp"
+#include "GF256/impl/bitplane.hpp"
+#include "GF256/impl/clmul.hpp"
+#include "GF256/impl/gemm.hpp"
+#include "GF256/impl/greased.hpp"
+#include "GF256/impl/basis.hpp"
+#include "GF256/StreamEncoder.hpp"
+#include "GF256/Tower.hpp"
 
 #include <unordered_set>
 #include <cstdio>
+#include <cstring>
 
 namespace chr = std::chrono;
 
@@ -24,140 +47,3467 @@ int get_msecs (const chr::steady_clock::duration &dur)
   return static_cast<int> (chr::duration_cast<chr::milliseconds> (dur).count ());
 }
 
+using Shards = std::vector<std::vector<GF256::Element>>;
+
+static Shards make_shards (int count, size_t len)
+{
+  return Shards (count, std::vector<GF256::Element> (len));
+}
+
+static void fill_random (std::vector<GF256::Element> &buffer)
+{
+  for (auto &el : buffer)
+    el = GF256::Element (static_cast<unsigned char> (std::rand () % 256));
+}
+
+static std::vector<GF256::Element *> shard_pointers (Shards &shards)
+{
+  std::vector<GF256::Element *> pointers;
+  for (auto &shard : shards)
+    pointers.push_back (shard.data ());
+  return pointers;
+}
+
+static bool run_bulk_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: BULK\n");
+
+  const size_t len = 1000 + 7;
+  std::vector<Element> src (len), dst (len), expected (len);
+
+  for (int c = 0; c < 256; c++)
+    {
+      Element coef (static_cast<unsigned char> (c));
+      fill_random (src);
+      fill_random (dst);
+
+      for (size_t i = 0; i < len; i++)
+        expected[i] = dst[i] + coef * src[i];
+
+      mul_add_region (coef, src.data (), dst.data (), len);
+      if (dst != expected)
+        {
+          printf ("SECTION RESULT: BULK: ERROR: mul_add_region by %s is wrong\n", to_string_as_polynom (coef).c_str ());
+          return false;
+        }
+
+      for (size_t i = 0; i < len; i++)
+        expected[i] = coef * src[i];
+
+      mul_region (coef, src.data (), dst.data (), len);
+      if (dst != expected)
+        {
+          printf ("SECTION RESULT: BULK: ERROR: mul_region by %s is wrong\n", to_string_as_polynom (coef).c_str ());
+          return false;
+        }
+    }
+
+  printf ("  mul_region, mul_add_region : OK\n");
+
+  Shards srcs = make_shards (10, len);
+  std::vector<const Element *> src_pointers;
+  std::vector<Element> coefs (10);
+  for (int j = 0; j < 10; j++)
+    {
+      fill_random (srcs[j]);
+      src_pointers.push_back (srcs[j].data ());
+    }
+  fill_random (coefs);
+
+  for (size_t i = 0; i < len; i++)
+    {
+      Element acc;
+      for (int j = 0; j < 10; j++)
+        acc += coefs[j] * srcs[j][i];
+      expected[i] = acc;
+    }
+
+  dot_product (coefs.data (), src_pointers.data (), 10, dst.data (), len);
+  if (dst != expected)
+    {
+      printf ("SECTION RESULT: BULK: ERROR: dot_product is wrong\n");
+      return false;
+    }
+
+  printf ("  dot_product : OK\n");
+
+  Shards outputs = make_shards (4, len);
+  Shards expected_outputs = outputs;
+  for (int j = 0; j < 4; j++)
+    {
+      fill_random (outputs[j]);
+      for (size_t i = 0; i < len; i++)
+        expected_outputs[j][i] = outputs[j][i] + coefs[j] * src[i];
+    }
+
+  std::vector<Element *> output_pointers = shard_pointers (outputs);
+  mul_add_multi (coefs.data (), src.data (), output_pointers.data (), 4, len);
+  if (outputs != expected_outputs)
+    {
+      printf ("SECTION RESULT: BULK: ERROR: mul_add_multi is wrong\n");
+      return false;
+    }
+
+  printf ("  mul_add_multi : OK\n");
+
+  if (crc32c ("123456789", 9) != 0xe3069283u)
+    {
+      printf ("SECTION RESULT: BULK: ERROR: crc32c check value is wrong\n");
+      return false;
+    }
+
+  printf ("  crc32c : OK\n");
+
+  std::vector<Element> matrix (3 * 10);
+  fill_random (matrix);
+  Shards fused = make_shards (3, len);
+  std::vector<Element *> fused_pointers = shard_pointers (fused);
+  std::vector<uint32_t> src_crcs (10), dst_crcs (3);
+  dot_product_multi_crc (matrix.data (), src_pointers.data (), 10, fused_pointers.data (), 3, len,
+                         src_crcs.data (), dst_crcs.data ());
+
+  for (int o = 0; o < 3; o++)
+    {
+      dot_product (matrix.data () + o * 10, src_pointers.data (), 10, dst.data (), len);
+      if (fused[o] != dst || dst_crcs[o] != crc32c (dst.data (), len))
+        {
+          printf ("SECTION RESULT: BULK: ERROR: dot_product_multi_crc output %d is wrong\n", o);
+          return false;
+        }
+    }
+
+  for (int j = 0; j < 10; j++)
+    if (src_crcs[j] != crc32c (srcs[j].data (), len))
+      {
+        printf ("SECTION RESULT: BULK: ERROR: dot_product_multi_crc source checksum %d is wrong\n", j);
+        return false;
+      }
+
+  uint32_t src_crc = 0;
+  std::vector<uint32_t> output_crcs (4);
+  expected_outputs = outputs;
+  for (int j = 0; j < 4; j++)
+    mul_add_region (coefs[j], src.data (), expected_outputs[j].data (), len);
+
+  mul_add_multi_crc (coefs.data (), src.data (), output_pointers.data (), 4, len, &src_crc, output_crcs.data ());
+  if (outputs != expected_outputs || src_crc != crc32c (src.data (), len))
+    {
+      printf ("SECTION RESULT: BULK: ERROR: mul_add_multi_crc is wrong\n");
+      return false;
+    }
+
+  for (int j = 0; j < 4; j++)
+    if (output_crcs[j] != crc32c (outputs[j].data (), len))
+      {
+        printf ("SECTION RESULT: BULK: ERROR: mul_add_multi_crc checksum %d is wrong\n", j);
+        return false;
+      }
+
+  printf ("  dot_product_multi_crc, mul_add_multi_crc : OK\n");
+
+  // gftbls of ISA-L's ec_init_tables: 32 bytes per coefficient, c * i then c * (i << 4)
+  Tables tables = expand_coefficients (matrix.data (), 3, 10);
+  for (int t = 0; t < 3 * 10; t++)
+    for (int i = 0; i < 16; i++)
+      {
+        const unsigned char *table = tables.gftbls () + 32 * t;
+        if (table[i] != (matrix[t] * Element (static_cast<unsigned char> (i))).additive_rep ()
+            || table[16 + i] != (matrix[t] * Element (static_cast<unsigned char> (i << 4))).additive_rep ())
+          {
+            printf ("SECTION RESULT: BULK: ERROR: expand_coefficients layout differs from gftbls\n");
+            return false;
+          }
+      }
+
+  Shards table_outputs = make_shards (3, len);
+  std::vector<Element *> table_pointers = shard_pointers (table_outputs);
+  dot_product_multi (tables, src_pointers.data (), table_pointers.data (), len);
+  if (table_outputs != fused)
+    {
+      printf ("SECTION RESULT: BULK: ERROR: dot_product_multi with Tables is wrong\n");
+      return false;
+    }
+
+  // accumulating the same sums again cancels them
+  dot_product_multi (tables, src_pointers.data (), table_pointers.data (), len, true);
+  if (table_outputs != make_shards (3, len))
+    {
+      printf ("SECTION RESULT: BULK: ERROR: accumulating dot_product_multi is wrong\n");
+      return false;
+    }
+
+  for (int o = 0; o < 3; o++)
+    {
+      dot_product (tables.row (o), src_pointers.data (), 10, dst.data (), len);
+      if (dst != fused[o] || !dot_product_equals (tables.row (o), src_pointers.data (), 10, fused[o].data (), len))
+        {
+          printf ("SECTION RESULT: BULK: ERROR: dot_product with tables of row %d is wrong\n", o);
+          return false;
+        }
+    }
+
+  mul_region (tables (1, 2), src.data (), dst.data (), len);
+  for (size_t i = 0; i < len; i++)
+    expected[i] = matrix[12] * src[i];
+  if (dst != expected)
+    {
+      printf ("SECTION RESULT: BULK: ERROR: mul_region with a table is wrong\n");
+      return false;
+    }
+
+  printf ("  expand_coefficients : OK\n");
+  printf ("SECTION RESULT: BULK: OK!\n");
+  return true;
+}
+
+static bool run_matrix_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: MATRIX\n");
+
+  for (int n = 1; n <= 32; n++)
+    {
+      Matrix m = cauchy_matrix (n, n, n);
+      auto inverse = m.inverse ();
+      if (!inverse || m * (*inverse) != Matrix::identity (n) || (*inverse) * m != Matrix::identity (n))
+        {
+          printf ("SECTION RESULT: MATRIX: ERROR: inverse of %dx%d Cauchy matrix is wrong\n", n, n);
+          return false;
+        }
+    }
+
+  printf ("  inverse : OK\n");
+
+  Matrix singular (3, 3);
+  for (int i = 0; i < 3; i++)
+    {
+      singular (0, i) = Element (static_cast<unsigned char> (i + 1));
+      singular (1, i) = Element (static_cast<unsigned char> (i + 5));
+      singular (2, i) = singular (0, i) + singular (1, i);
+    }
+
+  if (singular.inverse () || singular.rank () != 2 || singular.independent_rows () != std::vector<int> {0, 1})
+    {
+      printf ("SECTION RESULT: MATRIX: ERROR: singular matrix was not detected\n");
+      return false;
+    }
+
+  printf ("  singular : OK\n");
+  printf ("SECTION RESULT: MATRIX: OK!\n");
+  return true;
+}
+
+static bool run_reed_solomon_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: REED-SOLOMON\n");
+
+  const int k = 6;
+  const int m = 3;
+  const size_t len = 4096 + 3;
+  ReedSolomon rs (k, m);
+
+  Shards original = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (original[i]);
+
+  std::vector<Element *> pointers = shard_pointers (original);
+  rs.encode (pointers.data (), pointers.data () + k, len);
+
+  for (int mask = 0; mask < (1 << (k + m)); mask++)
+    {
+      int lost = __builtin_popcount (mask);
+      if (lost == 0 || lost > m + 1)
+        continue;
+
+      Shards damaged = original;
+      std::vector<bool> present (k + m, true);
+      for (int i = 0; i < k + m; i++)
+        if (mask & (1 << i))
+          {
+            present[i] = false;
+            fill_random (damaged[i]);
+          }
+
+      std::vector<Element *> damaged_pointers = shard_pointers (damaged);
+      bool ok = rs.reconstruct (damaged_pointers.data (), present, len);
+
+      if (ok != (lost <= m) || (ok && damaged != original))
+        {
+          printf ("SECTION RESULT: REED-SOLOMON: ERROR: erasure pattern %x handled wrong\n", mask);
+          return false;
+        }
+    }
+
+  printf ("  RS(%d, %d) every erasure pattern : OK\n", k, m);
+
+  for (size_t offset : {size_t (0), size_t (17), size_t (4096 - 100)})
+    {
+      size_t size = std::min (size_t (5000), len - offset);
+      std::vector<Element> old_data (original[2].begin () + offset, original[2].begin () + offset + size);
+      std::vector<Element> new_data (size);
+      fill_random (new_data);
+      std::copy (new_data.begin (), new_data.end (), original[2].begin () + offset);
+
+      Shards updated = original;
+      std::vector<Element *> updated_pointers = shard_pointers (updated);
+      rs.update_parity (2, offset, old_data.data (), new_data.data (), size, updated_pointers.data () + k);
+      rs.encode (pointers.data (), pointers.data () + k, len);
+
+      if (updated != original)
+        {
+          printf ("SECTION RESULT: REED-SOLOMON: ERROR: update_parity at offset %zu is wrong\n", offset);
+          return false;
+        }
+    }
+
+  printf ("  update_parity : OK\n");
+
+  std::vector<bool> degraded (k + m, true);
+  degraded[1] = false;
+  degraded[4] = false;
+  degraded[k] = false;
+  std::vector<const Element *> survivors (pointers.begin (), pointers.end ());
+  for (int missing : {1, 4, k})
+    for (size_t offset : {size_t (0), size_t (1), size_t (333), size_t (len - 40)})
+      {
+        size_t size = std::min (size_t (1500), len - offset);
+        std::vector<Element> window (size);
+        if (!rs.reconstruct_range (survivors.data (), degraded, missing, offset, size, window.data ())
+            || !std::equal (window.begin (), window.end (), original[missing].begin () + offset))
+          {
+            printf ("SECTION RESULT: REED-SOLOMON: ERROR: reconstruct_range of shard %d at %zu is wrong\n", missing, offset);
+            return false;
+          }
+      }
+
+  printf ("  reconstruct_range : OK\n");
+
+  std::vector<const Element *> const_pointers (pointers.begin (), pointers.end ());
+  if (!rs.verify (const_pointers.data (), const_pointers.data () + k, len).ok)
+    {
+      printf ("SECTION RESULT: REED-SOLOMON: ERROR: verify rejected a consistent stripe\n");
+      return false;
+    }
+
+  for (int shard : {0, k + 1})
+    for (size_t offset : {size_t (5), size_t (4096 + 1), len - 1})
+      {
+        original[shard][offset] += 1;
+        ReedSolomon::VerifyResult result = rs.verify (const_pointers.data (), const_pointers.data () + k, len, 1024);
+        original[shard][offset] += 1;
+
+        if (result.ok || result.block != offset / 1024 || (shard >= k && result.shard != shard))
+          {
+            printf ("SECTION RESULT: REED-SOLOMON: ERROR: verify missed corruption of shard %d at %zu\n", shard, offset);
+            return false;
+          }
+      }
+
+  printf ("  verify : OK\n");
+
+  const int stripes = 17;
+  const size_t small_len = 100 + 3;
+  Shards batch = make_shards (stripes * (k + m), small_len);
+  std::vector<Element *> batch_data, batch_parity;
+  for (int s = 0; s < stripes; s++)
+    for (int i = 0; i < k + m; i++)
+      {
+        Element *shard = batch[s * (k + m) + i].data ();
+        if (i < k)
+          {
+            fill_random (batch[s * (k + m) + i]);
+            batch_data.push_back (shard);
+          }
+        else
+          batch_parity.push_back (shard);
+      }
+
+  rs.encode_batch (batch_data.data (), batch_parity.data (), stripes, small_len);
+  for (int s = 0; s < stripes; s++)
+    {
+      std::vector<const Element *> stripe_pointers;
+      for (int i = 0; i < k + m; i++)
+        stripe_pointers.push_back (batch[s * (k + m) + i].data ());
+
+      if (!rs.verify (stripe_pointers.data (), stripe_pointers.data () + k, small_len).ok)
+        {
+          printf ("SECTION RESULT: REED-SOLOMON: ERROR: encode_batch stripe %d is wrong\n", s);
+          return false;
+        }
+    }
+
+  printf ("  encode_batch : OK\n");
+  printf ("SECTION RESULT: REED-SOLOMON: OK!\n");
+  return true;
+}
+
+static bool run_lrc_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: LRC\n");
+
+  const int k = 12;
+  const int l = 2;
+  const int r = 2;
+  const size_t len = 4096 + 5;
+  LRC lrc (k, l, r);
+  int n = lrc.total_shards ();
+
+  Shards original = make_shards (n, len);
+  for (int i = 0; i < k; i++)
+    fill_random (original[i]);
+
+  std::vector<Element *> pointers = shard_pointers (original);
+  lrc.encode (pointers.data (), pointers.data () + k, len);
+
+  for (int lost = 0; lost < n; lost++)
+    {
+      std::vector<int> sources = lrc.repair_sources (lost);
+      int expected_count = lrc.group (lost) < 0 ? k : k / l;
+      if (static_cast<int> (sources.size ()) != expected_count)
+        {
+          printf ("SECTION RESULT: LRC: ERROR: repair of shard %d reads %d shards\n", lost, static_cast<int> (sources.size ()));
+          return false;
+        }
+
+      // only the repair sources survive, so reading anything else shows up as a mismatch
+      Shards damaged = make_shards (n, len);
+      for (int source : sources)
+        damaged[source] = original[source];
+
+      std::vector<Element *> damaged_pointers = shard_pointers (damaged);
+      lrc.repair (lost, damaged_pointers.data (), len);
+      if (damaged[lost] != original[lost])
+        {
+          printf ("SECTION RESULT: LRC: ERROR: local repair of shard %d is wrong\n", lost);
+          return false;
+        }
+    }
+
+  printf ("  LRC(%d, %d, %d) single failure repair : OK\n", k, l, r);
+
+  int recovered = 0;
+  for (int mask = 0; mask < (1 << n); mask++)
+    {
+      int lost = __builtin_popcount (mask);
+      if (lost == 0 || lost > r + 2)
+        continue;
+
+      Shards damaged = original;
+      std::vector<bool> present (n, true);
+      for (int i = 0; i < n; i++)
+        if (mask & (1 << i))
+          {
+            present[i] = false;
+            fill_random (damaged[i]);
+          }
+
+      std::vector<Element *> damaged_pointers = shard_pointers (damaged);
+      bool ok = lrc.reconstruct (damaged_pointers.data (), present, len);
+
+      if ((lost <= r + 1 && !ok) || (ok && damaged != original))
+        {
+          printf ("SECTION RESULT: LRC: ERROR: erasure pattern %x handled wrong\n", mask);
+          return false;
+        }
+
+      recovered += ok;
+    }
+
+  printf ("  LRC(%d, %d, %d) every pattern of up to %d failures : OK (%d recovered)\n", k, l, r, r + 2, recovered);
+  printf ("SECTION RESULT: LRC: OK!\n");
+  return true;
+}
+
+
+static bool run_stream_encoder_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: STREAM ENCODER\n");
+
+  const int k = 4;
+  const int m = 2;
+  const size_t shard_len = 1000;
+  ReedSolomon rs (k, m);
+
+  for (size_t stream_len : {size_t (0), size_t (1), size_t (4000), size_t (123457)})
+    {
+      std::vector<Element> stream (stream_len);
+      fill_random (stream);
+
+      Shards received;
+      uint64_t expected_index = 0;
+      bool in_order = true;
+      {
+        StreamEncoder encoder (rs, shard_len, 3, [&] (const StreamEncoder::Stripe &stripe)
+          {
+            in_order = in_order && stripe.index == expected_index++;
+            for (int i = 0; i < k + m; i++)
+              received.emplace_back (stripe.shards[i], stripe.shards[i] + stripe.shard_len);
+          });
+
+        // uneven chunks, as from a pipe
+        for (size_t done = 0, chunk = 1; done < stream_len; done += chunk, chunk = chunk * 3 % 7919 + 1)
+          encoder.write (stream.data () + done, std::min (chunk, stream_len - done));
+      }
+
+      size_t stripes = received.size () / (k + m);
+      bool ok = in_order && stripes == (stream_len + k * shard_len - 1) / (k * shard_len);
+      for (size_t s = 0; ok && s < stripes; s++)
+        {
+          std::vector<Element *> pointers;
+          for (int i = 0; i < k + m; i++)
+            pointers.push_back (received[s * (k + m) + i].data ());
+
+          for (size_t b = 0; b < k * shard_len; b++)
+            {
+              size_t pos = s * k * shard_len + b;
+              Element expected = pos < stream_len ? stream[pos] : zero_element ();
+              ok = ok && pointers[b / shard_len][b % shard_len] == expected;
+            }
+
+          std::vector<const Element *> const_pointers (pointers.begin (), pointers.end ());
+          ok = ok && rs.verify (const_pointers.data (), const_pointers.data () + k, shard_len).ok;
+        }
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: STREAM ENCODER: ERROR: stream of %zu bytes encoded wrong\n", stream_len);
+          return false;
+        }
+
+      printf ("  %zu bytes -> %zu stripes : OK\n", stream_len, stripes);
+    }
+
+  // the stage threads of an idle stream sleep instead of spinning
+  {
+    StreamEncoder encoder (rs, shard_len, 3, [] (const StreamEncoder::Stripe &) {});
+    std::clock_t cpu_begin = std::clock ();
+    std::this_thread::sleep_for (std::chrono::milliseconds (300));
+    double cpu_msecs = 1000.0 * (std::clock () - cpu_begin) / CLOCKS_PER_SEC;
+    if (cpu_msecs > 100)
+      {
+        printf ("SECTION RESULT: STREAM ENCODER: ERROR: an idle stream used %.0f ms of CPU in 300 ms\n", cpu_msecs);
+        return false;
+      }
+    printf ("  idle stream : OK\n");
+  }
+
+  printf ("SECTION RESULT: STREAM ENCODER: OK!\n");
+  return true;
+}
+
+static const char *backend_name (GF256::ShardIO::Backend backend)
+{
+  return backend == GF256::ShardIO::Backend::io_uring ? "io_uring" : "thread pool";
+}
+
+static bool run_shard_io_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: SHARD IO\n");
+
+  const int k = 4;
+  const int m = 2;
+  const size_t shard_len = 64 << 10;
+  const int stripes = 8;
+
+  char dir[] = "/tmp/gf256-shard-io-XXXXXX";
+  if (!mkdtemp (dir))
+    {
+      printf ("SECTION RESULT: SHARD IO: ERROR: cannot create a temporary directory\n");
+      return false;
+    }
+
+  ReedSolomon rs (k, m);
+  bool ok = true;
+  for (ShardIO::Backend backend : {ShardIO::Backend::automatic, ShardIO::Backend::thread_pool})
+    {
+      ShardIO io (8, backend);
+
+      std::vector<int> fds;
+      for (int i = 0; i < k + m; i++)
+        fds.push_back (open_shard_file (std::string (dir) + "/shard." + std::to_string (i), true));
+
+      // two stripe buffers: one is written while the other is encoded
+      std::vector<std::vector<AlignedBuffer>> buffers (2);
+      std::vector<std::vector<Element>> written;
+      uint64_t pending[2] = {0, 0};
+      bool has_pending[2] = {false, false};
+      for (int s = 0; s < stripes; s++)
+        {
+          auto &stripe = buffers[s % 2];
+          if (has_pending[s % 2])
+            ok = ok && io.wait (pending[s % 2]);
+          if (stripe.empty ())
+            for (int i = 0; i < k + m; i++)
+              stripe.emplace_back (shard_len);
+
+          std::vector<Element *> pointers;
+          for (auto &buffer : stripe)
+            pointers.push_back (buffer.data ());
+          for (int i = 0; i < k; i++)
+            for (size_t b = 0; b < shard_len; b++)
+              pointers[i][b] = Element (static_cast<unsigned char> (std::rand () % 256));
+          rs.encode (pointers.data (), pointers.data () + k, shard_len);
+
+          std::vector<ShardIO::Request> requests;
+          for (int i = 0; i < k + m; i++)
+            {
+              requests.push_back ({fds[i], pointers[i], shard_len, s * shard_len, true});
+              written.emplace_back (pointers[i], pointers[i] + shard_len);
+            }
+
+          pending[s % 2] = io.submit (requests);
+          has_pending[s % 2] = true;
+        }
+
+      for (int b = 0; b < 2; b++)
+        if (has_pending[b])
+          ok = ok && io.wait (pending[b]);
+
+      for (int fd : fds)
+        close (fd);
+
+      // read everything back in one batch
+      std::vector<AlignedBuffer> read_back;
+      std::vector<ShardIO::Request> requests;
+      for (int i = 0; i < k + m; i++)
+        fds[i] = open_shard_file (std::string (dir) + "/shard." + std::to_string (i), false);
+      for (int s = 0; s < stripes; s++)
+        for (int i = 0; i < k + m; i++)
+          {
+            read_back.emplace_back (shard_len);
+            requests.push_back ({fds[i], read_back.back ().data (), shard_len, s * shard_len, false});
+          }
+
+      ok = ok && io.wait (io.submit (requests));
+      for (size_t r = 0; ok && r < read_back.size (); r++)
+        ok = std::equal (written[r].begin (), written[r].end (), read_back[r].data ());
+
+      // a read running past the end of the file comes back short on either backend, and fails
+      AlignedBuffer past_end (2 * shard_len);
+      ok = ok && !io.wait (io.submit ({{fds[0], past_end.data (), 2 * shard_len, (stripes - 1) * shard_len, false}}));
+
+      for (int fd : fds)
+        close (fd);
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: SHARD IO: ERROR: %s round trip failed\n", backend_name (io.backend ()));
+          break;
+        }
+
+      printf ("  %s write + read : OK\n", backend_name (io.backend ()));
+    }
+
+  for (int i = 0; i < k + m; i++)
+    unlink ((std::string (dir) + "/shard." + std::to_string (i)).c_str ());
+  rmdir (dir);
+
+  if (!ok)
+    return false;
+
+  printf ("SECTION RESULT: SHARD IO: OK!\n");
+  return true;
+}
+
+static std::vector<unsigned char> read_whole_file (const std::string &path)
+{
+  std::vector<unsigned char> contents;
+  FILE *file = fopen (path.c_str (), "rb");
+  if (!file)
+    return contents;
+
+  int c;
+  while ((c = fgetc (file)) != EOF)
+    contents.push_back (static_cast<unsigned char> (c));
+  fclose (file);
+  return contents;
+}
+
+static void flip_file_byte (const std::string &path, long offset)
+{
+  FILE *file = fopen (path.c_str (), "r+b");
+  if (!file)
+    return;
+
+  fseek (file, offset, SEEK_SET);
+  int c = fgetc (file);
+  fseek (file, offset, SEEK_SET);
+  fputc (c ^ 0x5a, file);
+  fclose (file);
+}
+
+static bool run_file_modes_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: FILE MODES\n");
+
+  char dir[] = "/tmp/gf256-file-modes-XXXXXX";
+  if (!mkdtemp (dir))
+    {
+      printf ("SECTION RESULT: FILE MODES: ERROR: cannot create a temporary directory\n");
+      return false;
+    }
+
+  const int k = 5;
+  const int m = 3;
+  const std::string input = std::string (dir) + "/input";
+  const std::string shard_dir = std::string (dir) + "/shards";
+  const std::string output = std::string (dir) + "/output";
+  auto shard = [&] (int i) {char name[32]; snprintf (name, sizeof (name), "/shard.%03d", i); return shard_dir + name;};
+
+  // an odd size, so the last data shard is padded
+  std::vector<unsigned char> contents (100003);
+  for (auto &byte : contents)
+    byte = static_cast<unsigned char> (std::rand () % 256);
+  FILE *file = fopen (input.c_str (), "wb");
+  fwrite (contents.data (), 1, contents.size (), file);
+  fclose (file);
+
+  std::string k_arg = std::to_string (k);
+  std::string m_arg = std::to_string (m);
+  char *encode_args[] = {const_cast<char *> ("GF256"), const_cast<char *> ("encode"), const_cast<char *> (input.c_str ()),
+                         k_arg.data (), m_arg.data (), const_cast<char *> (shard_dir.c_str ())};
+  char *decode_args[] = {const_cast<char *> ("GF256"), const_cast<char *> ("decode"), const_cast<char *> (shard_dir.c_str ()),
+                         const_cast<char *> (output.c_str ())};
+
+  bool ok = run_encode_mode (6, encode_args) == 0;
+
+  // m shards lost: one erased, one with a corrupted payload and one with a damaged file_size in its header
+  unlink (shard (2).c_str ());
+  flip_file_byte (shard (k + 1), 64 + 1000);
+  flip_file_byte (shard (0), 32);
+  ok = ok && run_decode_mode (4, decode_args) == 0 && read_whole_file (output) == contents;
+  if (ok)
+    printf ("  round trip with %d damaged shards : OK\n", m);
+
+  // one more loss is beyond repair, and decode must not leave a wrong file behind
+  unlink (output.c_str ());
+  unlink (shard (k).c_str ());
+  bool rejected = run_decode_mode (4, decode_args) != 0 && access (output.c_str (), F_OK) != 0;
+  if (ok && rejected)
+    printf ("  too many damaged shards rejected : OK\n");
+
+  unlink (input.c_str ());
+  unlink (output.c_str ());
+  for (int i = 0; i < k + m; i++)
+    unlink (shard (i).c_str ());
+  rmdir (shard_dir.c_str ());
+  rmdir (dir);
+
+  if (!ok || !rejected)
+    {
+      printf ("SECTION RESULT: FILE MODES: ERROR: %s\n", ok ? "decode accepted a lost stripe" : "round trip failed");
+      return false;
+    }
+
+  printf ("SECTION RESULT: FILE MODES: OK!\n");
+  return true;
+}
+
+// encode, lose two shards, reconstruct, all on the executor
+static GF256::Task<bool> encode_and_repair (GF256::QueueExecutor &executor, const GF256::ReedSolomon &rs,
+                                            Shards &shards, size_t len, size_t chunk_len)
+{
+  using namespace GF256;
+
+  int k = rs.data_shards ();
+  std::vector<Element *> pointers = shard_pointers (shards);
+  std::vector<const Element *> data (pointers.begin (), pointers.begin () + k);
+  std::vector<Element *> parity (pointers.begin () + k, pointers.end ());
+  co_await encode_async (executor, rs, data, parity, len, chunk_len);
+
+  Shards original = shards;
+  std::vector<bool> present (rs.total_shards (), true);
+  present[0] = false;
+  present[k] = false;
+  std::fill (shards[0].begin (), shards[0].end (), zero_element ());
+  std::fill (shards[k].begin (), shards[k].end (), zero_element ());
+
+  bool ok = co_await reconstruct_async (executor, rs, pointers, present, len, chunk_len);
+  co_return ok && shards == original;
+}
+
+static bool run_async_codec_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: ASYNC CODEC\n");
+
+  const int k = 5;
+  const int m = 3;
+  const size_t len = 10000;
+  const size_t chunk_len = 1024;
+  ReedSolomon rs (k, m);
+  QueueExecutor executor;
+
+  Shards first = make_shards (k + m, len);
+  Shards second = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    {
+      fill_random (first[i]);
+      fill_random (second[i]);
+    }
+
+  Task<bool> first_task = encode_and_repair (executor, rs, first, len, chunk_len);
+  Task<bool> second_task = encode_and_repair (executor, rs, second, len, chunk_len);
+  first_task.start ();
+  second_task.start ();
+
+  // both tasks must make progress in turns: each step resumes one chunk of one task
+  int steps = 0;
+  bool ran_ahead = false;
+  while (executor.run_one ())
+    {
+      steps++;
+      ran_ahead = ran_ahead || (steps < 10 && first_task.done () != second_task.done ());
+    }
+
+  int chunks = static_cast<int> ((len + chunk_len - 1) / chunk_len);
+  if (!first_task.done () || !second_task.done () || !first_task.result () || !second_task.result ()
+      || steps != 4 * chunks || ran_ahead)
+    {
+      printf ("SECTION RESULT: ASYNC CODEC: ERROR: encode_async / reconstruct_async produced wrong result\n");
+      return false;
+    }
+
+  printf ("  encode_async, reconstruct_async : OK (%d executor steps)\n", steps);
+
+  std::vector<bool> lost (k + m, false);
+  std::vector<Element *> pointers = shard_pointers (first);
+  Task<bool> failing = reconstruct_async (executor, rs, pointers, lost, len, chunk_len);
+  failing.start ();
+  executor.run ();
+  if (!failing.done () || failing.result ())
+    {
+      printf ("SECTION RESULT: ASYNC CODEC: ERROR: reconstruct_async of a lost stripe succeeded\n");
+      return false;
+    }
+
+  printf ("  lost stripe : OK\n");
+  printf ("SECTION RESULT: ASYNC CODEC: OK!\n");
+  return true;
+}
+
+template <int K, int M>
+static bool check_fixed_reed_solomon ()
+{
+  using namespace GF256;
+  using Codec = FixedReedSolomon<K, M>;
+
+  ReedSolomon rs (K, M);
+  for (int i = 0; i < M; i++)
+    for (int j = 0; j < K; j++)
+      if (Codec::coefficient (i, j) != rs.coefficient (i, j))
+        {
+          printf ("SECTION RESULT: FIXED REED-SOLOMON: ERROR: RS(%d, %d) matrix differs\n", K, M);
+          return false;
+        }
+
+  for (size_t len : {0, 15, 16, 1000, 4096, 4099})
+    {
+      Shards expected = make_shards (K + M, len);
+      for (int i = 0; i < K; i++)
+        fill_random (expected[i]);
+      Shards actual = expected;
+
+      std::vector<Element *> expected_ptrs = shard_pointers (expected);
+      std::vector<Element *> actual_ptrs = shard_pointers (actual);
+      rs.encode (expected_ptrs.data (), expected_ptrs.data () + K, len);
+      Codec::encode (actual_ptrs.data (), actual_ptrs.data () + K, len);
+
+      std::vector<bool> present (K + M, true);
+      for (int i = 0; i < M; i++)
+        {
+          present[i] = false;
+          std::fill (actual[i].begin (), actual[i].end (), zero_element ());
+        }
+
+      if (!Codec::reconstruct (actual_ptrs.data (), present, len) || actual != expected)
+        {
+          printf ("SECTION RESULT: FIXED REED-SOLOMON: ERROR: RS(%d, %d) differs for len %d\n",
+                  K, M, static_cast<int> (len));
+          return false;
+        }
+    }
+
+  printf ("  FixedReedSolomon<%d, %d> : OK\n", K, M);
+  return true;
+}
+
+static bool run_fixed_reed_solomon_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: FIXED REED-SOLOMON\n");
+
+  // the matrix is usable in constant expressions
+  static_assert (FixedReedSolomon<8, 3>::coefficient (1, 2)
+                 == inv (Element (static_cast<unsigned char> (9)) + Element (static_cast<unsigned char> (2))));
+  static_assert (FixedReedSolomon<8, 3>::parity_tables[0].low[1] == FixedReedSolomon<8, 3>::coefficient (0, 0).additive_rep ());
+
+  if (!check_fixed_reed_solomon<8, 3> () || !check_fixed_reed_solomon<12, 4> ()
+      || !check_fixed_reed_solomon<10, 6> () || !check_fixed_reed_solomon<4, 12> ()
+      || !check_fixed_reed_solomon<1, 1> ())
+    return false;
+
+  printf ("SECTION RESULT: FIXED REED-SOLOMON: OK!\n");
+  return true;
+}
+
+static bool run_bitmatrix_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: BITMATRIX CODEC\n");
+
+  for (int c = 0; c < 256; c++)
+    {
+      Element coef (static_cast<unsigned char> (c));
+      std::array<unsigned char, 8> rows = multiply_bitmatrix (coef);
+      for (int x = 0; x < 256; x++)
+        {
+          unsigned char product = 0;
+          for (int r = 0; r < 8; r++)
+            if (__builtin_parity (rows[r] & x))
+              product |= static_cast<unsigned char> (1 << r);
+
+          if (product != (coef * Element (static_cast<unsigned char> (x))).additive_rep ())
+            {
+              printf ("SECTION RESULT: BITMATRIX CODEC: ERROR: multiply_bitmatrix (%d) is wrong\n", c);
+              return false;
+            }
+        }
+    }
+
+  printf ("  multiply_bitmatrix : OK\n");
+
+  const int k = 6;
+  const int m = 3;
+  const size_t packet_size = 32;
+  const size_t len = 3 * 8 * packet_size;
+  BitmatrixCodec codec (k, m, packet_size);
+  BitmatrixCodec plain (k, m, packet_size, false);
+
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+  Shards plain_shards = shards;
+  std::vector<Element *> pointers = shard_pointers (shards);
+  std::vector<Element *> plain_pointers = shard_pointers (plain_shards);
+  codec.encode (pointers.data (), pointers.data () + k, len);
+  plain.encode (plain_pointers.data (), plain_pointers.data () + k, len);
+
+  if (shards != plain_shards || codec.encode_schedule ().xor_count () >= plain.encode_schedule ().xor_count ())
+    {
+      printf ("SECTION RESULT: BITMATRIX CODEC: ERROR: optimized schedule differs or saves nothing\n");
+      return false;
+    }
+
+  printf ("  encode schedule : OK (%d XORs, %d unoptimized)\n", codec.encode_schedule ().xor_count (),
+          plain.encode_schedule ().xor_count ());
+
+  // every pattern of at most m erasures
+  for (int mask = 0; mask < (1 << (k + m)); mask++)
+    {
+      if (__builtin_popcount (mask) > m)
+        continue;
+
+      Shards damaged = shards;
+      std::vector<bool> present (k + m, true);
+      for (int i = 0; i < k + m; i++)
+        if (mask & (1 << i))
+          {
+            present[i] = false;
+            std::fill (damaged[i].begin (), damaged[i].end (), zero_element ());
+          }
+
+      std::vector<Element *> damaged_pointers = shard_pointers (damaged);
+      if (!codec.reconstruct (damaged_pointers.data (), present, len) || damaged != shards)
+        {
+          printf ("SECTION RESULT: BITMATRIX CODEC: ERROR: reconstruct failed for erasure mask %d\n", mask);
+          return false;
+        }
+    }
+
+  printf ("  reconstruct : OK\n");
+  printf ("SECTION RESULT: BITMATRIX CODEC: OK!\n");
+  return true;
+}
+
+static const char *bitplane_kernel_name (GF256::BitplaneKernel kernel)
+{
+  switch (kernel)
+    {
+    case GF256::BitplaneKernel::scalar: return "scalar";
+    case GF256::BitplaneKernel::sse2:   return "sse2";
+    case GF256::BitplaneKernel::avx2:   return "avx2";
+    case GF256::BitplaneKernel::avx512: return "avx512";
+    }
+  return "";
+}
+
+static const GF256::BitplaneKernel bitplane_kernels[] = {GF256::BitplaneKernel::scalar, GF256::BitplaneKernel::sse2,
+                                                          GF256::BitplaneKernel::avx2, GF256::BitplaneKernel::avx512};
+
+static bool run_bitplane_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: BITPLANE\n");
+
+  for (BitplaneKernel kernel : bitplane_kernels)
+    {
+      if (!bitplane_kernel_supported (kernel))
+        {
+          printf ("  %s : not supported by this CPU\n", bitplane_kernel_name (kernel));
+          continue;
+        }
+
+      for (size_t len : {0, 5, 8, 16, 63, 64, 200, 4099})
+        {
+          std::vector<Element> src (len);
+          fill_random (src);
+
+          size_t plane_len = (len + 7) / 8;
+          std::vector<std::vector<unsigned char>> planes (8, std::vector<unsigned char> (plane_len, 0xff));
+          std::vector<unsigned char *> plane_ptrs;
+          for (auto &plane : planes)
+            plane_ptrs.push_back (plane.data ());
+
+          to_bitplanes (src.data (), plane_ptrs.data (), len, kernel);
+
+          bool ok = true;
+          for (int b = 0; b < 8; b++)
+            for (size_t i = 0; i < plane_len * 8; i++)
+              {
+                int expected = i < len ? (src[i].additive_rep () >> b) & 1 : 0;
+                ok = ok && ((planes[b][i / 8] >> (i % 8)) & 1) == expected;
+              }
+
+          std::vector<Element> back (len);
+          from_bitplanes (plane_ptrs.data (), back.data (), len, kernel);
+
+          if (!ok || back != src)
+            {
+              printf ("SECTION RESULT: BITPLANE: ERROR: %s kernel is wrong for len %d\n",
+                      bitplane_kernel_name (kernel), static_cast<int> (len));
+              return false;
+            }
+        }
+
+      printf ("  %s : OK\n", bitplane_kernel_name (kernel));
+    }
+
+  printf ("SECTION RESULT: BITPLANE: OK!\n");
+  return true;
+}
+
+static bool run_constant_time_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: CONSTANT TIME\n");
+
+  static_assert (ct::inv (ct::mul (3, 7)) == ct::mul (ct::inv (3), ct::inv (7)));
+
+  for (int x = 0; x < 256; x++)
+    {
+      Element a (static_cast<unsigned char> (x));
+      bool ok = x == 0 ? ct::inv (a) == zero_element () : ct::inv (a) == inv (a);
+      for (int power : {0, 1, 2, 7, 200, 254, 255, 1000})
+        ok = ok && ct::pow (a, power) == pow (a, power);
+
+      for (int y = 0; y < 256 && ok; y++)
+        {
+          Element b (static_cast<unsigned char> (y));
+          ok = ct::mul (a, b) == a * b;
+          ok = ok && (y == 0 ? ct::div (a, b) == zero_element () : ct::div (a, b) == a / b);
+
+          ConstantTimeElement secret_a (a);
+          ConstantTimeElement secret_b (b);
+          ok = ok && (secret_a * secret_b).element () == a * b && (secret_a + secret_b).element () == a + b;
+          ok = ok && (y == 0 || (secret_a / secret_b).element () == a / b);
+        }
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: CONSTANT TIME: ERROR: scalar arithmetic differs for %d\n", x);
+          return false;
+        }
+    }
+
+  printf ("  mul, div, inv, pow, ConstantTimeElement : OK\n");
+
+  for (size_t len : {0, 1, 255, 256, 2048, 5000})
+    {
+      std::vector<Element> a (len), b (len), dst (len), expected (len);
+      fill_random (a);
+      fill_random (b);
+      Element coef (static_cast<unsigned char> (0x5a));
+
+      bool ok = true;
+      ct::mul_region (a.data (), b.data (), dst.data (), len);
+      for (size_t i = 0; i < len; i++)
+        ok = ok && dst[i] == a[i] * b[i];
+
+      ct::mul_region (coef, a.data (), dst.data (), len);
+      mul_region (coef, a.data (), expected.data (), len);
+      ok = ok && dst == expected;
+
+      ct::mul_add_region (coef, b.data (), dst.data (), len);
+      mul_add_region (coef, b.data (), expected.data (), len);
+      ok = ok && dst == expected;
+
+      ct::inv_region (a.data (), dst.data (), len);
+      for (size_t i = 0; i < len; i++)
+        ok = ok && dst[i] == (a[i] == zero_element () ? zero_element () : inv (a[i]));
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: CONSTANT TIME: ERROR: bit-sliced regions differ for len %d\n", static_cast<int> (len));
+          return false;
+        }
+    }
+
+  printf ("  bit-sliced regions : OK\n");
+  printf ("SECTION RESULT: CONSTANT TIME: OK!\n");
+  return true;
+}
+
+static const char *clmul_kernel_name (GF256::ClmulKernel kernel)
+{
+  switch (kernel)
+    {
+    case GF256::ClmulKernel::none:    return "none";
+    case GF256::ClmulKernel::pclmul:  return "pclmul";
+    case GF256::ClmulKernel::vpclmul: return "vpclmul";
+    }
+  return "";
+}
+
+static const GF256::ClmulKernel clmul_kernels[] = {GF256::ClmulKernel::none, GF256::ClmulKernel::pclmul,
+                                                   GF256::ClmulKernel::vpclmul};
+
+static bool run_clmul_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: CLMUL\n");
+
+  for (ClmulKernel kernel : clmul_kernels)
+    {
+      if (!clmul_kernel_supported (kernel))
+        {
+          printf ("  %s : not supported by this CPU\n", clmul_kernel_name (kernel));
+          continue;
+        }
+
+      // every coefficient against every byte value
+      std::vector<Element> all (256), product (256);
+      for (int x = 0; x < 256; x++)
+        all[x] = Element (static_cast<unsigned char> (x));
+
+      for (int c = 0; c < 256; c++)
+        {
+          clmul_mul_region (all[c], all.data (), product.data (), 256, kernel);
+          for (int x = 0; x < 256; x++)
+            if (product[x] != all[c] * all[x])
+              {
+                printf ("SECTION RESULT: CLMUL: ERROR: %s product %d * %d is wrong\n", clmul_kernel_name (kernel), c, x);
+                return false;
+              }
+        }
+
+      for (int outputs : {1, 3, 6})
+        for (size_t len : {0, 15, 64, 100, 4099})
+          {
+            const int count = 7;
+            Shards srcs = make_shards (count, len);
+            for (auto &src : srcs)
+              fill_random (src);
+            std::vector<Element> coefs (count * outputs);
+            fill_random (coefs);
+
+            Shards expected = make_shards (outputs, len);
+            Shards actual = make_shards (outputs, len);
+            std::vector<const Element *> src_ptrs;
+            for (auto &src : srcs)
+              src_ptrs.push_back (src.data ());
+            std::vector<Element *> actual_ptrs = shard_pointers (actual);
+
+            for (int o = 0; o < outputs; o++)
+              dot_product (coefs.data () + o * count, src_ptrs.data (), count, expected[o].data (), len);
+            clmul_dot_product_multi (coefs.data (), src_ptrs.data (), count, actual_ptrs.data (), outputs, len, kernel);
+
+            if (actual != expected)
+              {
+                printf ("SECTION RESULT: CLMUL: ERROR: %s dot product differs for %d outputs, len %d\n",
+                        clmul_kernel_name (kernel), outputs, static_cast<int> (len));
+                return false;
+              }
+          }
+
+      printf ("  %s : OK\n", clmul_kernel_name (kernel));
+    }
+
+  printf ("SECTION RESULT: CLMUL: OK!\n");
+  return true;
+}
+
+// every operator of Vec<N> lane by lane against Element
+template <int N>
+static bool check_vec ()
+{
+  using namespace GF256;
+
+  std::vector<Element> a (N), b (N), out (N);
+  for (int round = 0; round < 200; round++)
+    {
+      fill_random (a);
+      fill_random (b);
+      b[round % N] = zero_element ();
+      Element scalar (static_cast<unsigned char> (round + 1));
+
+      Vec<N> va = Vec<N>::load (a);
+      Vec<N> vb = Vec<N>::load (b);
+      Vec<N> nonzero_b = select (vb == Vec<N> (zero_element ()), Vec<N> (scalar), vb);
+      int power = round * 7 - 300;
+
+      Vec<N> sum = va + vb;
+      Vec<N> product = va * vb;
+      Vec<N> scaled = va * scalar;
+      Vec<N> quotient = va / nonzero_b;
+      Vec<N> inverse = inv (nonzero_b);
+      Vec<N> powered = pow (va, power);
+      Mask<N> equal = va == vb;
+      Mask<N> less = va < vb;
+
+      for (int i = 0; i < N; i++)
+        {
+          Element divisor = b[i] == zero_element () ? scalar : b[i];
+          // ct::pow reduces negative exponents modulo 255 the same way
+          Element expected_power = ct::pow (a[i], power);
+          if (sum[i] != a[i] + b[i] || product[i] != a[i] * b[i] || scaled[i] != a[i] * scalar
+              || quotient[i] != a[i] / divisor || inverse[i] != inv (divisor) || powered[i] != expected_power
+              || equal[i] != (a[i] == b[i]) || less[i] != (a[i] < b[i]) || (va - vb)[i] != a[i] - b[i])
+            {
+              printf ("SECTION RESULT: VEC: ERROR: Vec<%d> lane %d differs from Element\n", N, i);
+              return false;
+            }
+        }
+
+      if ((va == va).all () != true || (va != va).any () || (va != vb).count () + equal.count () != N)
+        {
+          printf ("SECTION RESULT: VEC: ERROR: Vec<%d> masks are wrong\n", N);
+          return false;
+        }
+
+      va *= vb;
+      va += Vec<N> (scalar);
+      va.store (out);
+      for (int i = 0; i < N; i++)
+        if (out[i] != a[i] * b[i] + scalar)
+          {
+            printf ("SECTION RESULT: VEC: ERROR: Vec<%d> store is wrong\n", N);
+            return false;
+          }
+    }
+
+  printf ("  Vec<%d> : OK\n", N);
+  return true;
+}
+
+static bool run_vec_section ()
+{
+  printf ("SECTION: VEC\n");
+
+  if (!check_vec<16> () || !check_vec<32> () || !check_vec<64> ())
+    return false;
+
+  printf ("SECTION RESULT: VEC: OK!\n");
+  return true;
+}
+
+static bool run_buffer_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: BUFFER\n");
+
+  for (size_t len : {0, 5, 16, 47, 1000})
+    {
+      std::vector<Element> values (len);
+      fill_random (values);
+      Buffer x (values);
+      fill_random (values);
+      Buffer y (values);
+      fill_random (values);
+      Buffer w (values);
+      Element a (static_cast<unsigned char> (0x1d));
+      Element b (static_cast<unsigned char> (0xe7));
+
+      Buffer z = a * x + b * y + w;
+      Buffer product (len);
+      product = x * y - w * b;
+
+      bool ok = z.size () == len;
+      for (size_t i = 0; i < len && ok; i++)
+        ok = z[i] == a * x[i] + b * y[i] + w[i] && product[i] == x[i] * y[i] + w[i] * b;
+
+      // the expression reads the buffer it is assigned to
+      Buffer expected (len);
+      for (size_t i = 0; i < len; i++)
+        expected[i] = a * z[i] + x[i] * (y[i] + w[i]);
+      z = a * z + x * (y + w);
+      ok = ok && z == expected;
+
+      z += x;
+      z *= b;
+      for (size_t i = 0; i < len; i++)
+        expected[i] = (expected[i] + x[i]) * b;
+      ok = ok && z == expected;
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: BUFFER: ERROR: expressions are wrong for len %d\n", static_cast<int> (len));
+          return false;
+        }
+    }
+
+  printf ("  a * x + b * y + w, x * y, aliasing : OK\n");
+  printf ("SECTION RESULT: BUFFER: OK!\n");
+  return true;
+}
+
+static bool run_gemm_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: GEMM\n");
+
+  const int sizes[][3] = {{1, 1, 1}, {3, 5, 31}, {4, 4, 32}, {7, 9, 100}, {13, 300, 77}, {70, 20, 5000}};
+  // small tiles, so every size crosses tile and panel boundaries
+  const GemmBlocking small_tiles {8, 16, 64};
+  for (const auto &size : sizes)
+    {
+      const int m = size[0];
+      const int k = size[1];
+      const size_t n = size[2];
+      std::vector<Element> a (m * k), b (k * n), c (m * n);
+      fill_random (a);
+      fill_random (b);
+      fill_random (c);
+
+      std::vector<Element> product (m * n);
+      for (int i = 0; i < m; i++)
+        for (int j = 0; j < k; j++)
+          for (size_t l = 0; l < n; l++)
+            product[i * n + l] += a[i * k + j] * b[j * n + l];
+
+      std::vector<Element> sum = c;
+      for (size_t i = 0; i < sum.size (); i++)
+        sum[i] += product[i];
+
+      for (int threads : {1, 3})
+        for (GemmBlocking blocking : {GemmBlocking {}, small_tiles})
+          {
+            std::vector<Element> result = c;
+            gemm (m, k, n, a.data (), k, b.data (), n, result.data (), n, false, threads, blocking);
+            std::vector<Element> accumulated = c;
+            gemm (m, k, n, a.data (), k, b.data (), n, accumulated.data (), n, true, threads, blocking);
+            if (result != product || accumulated != sum)
+              {
+                printf ("SECTION RESULT: GEMM: ERROR: %dx%d times %dx%d is wrong with %d threads\n",
+                        m, k, k, static_cast<int> (n), threads);
+                return false;
+              }
+          }
+    }
+  printf ("  against the naive product, accumulate, threads : OK\n");
+
+  // a submatrix through the leading dimensions
+  Matrix a = cauchy_matrix (6, 10, 10);
+  Matrix b = cauchy_matrix (10, 9, 10);
+  Matrix c (6, 9);
+  gemm (3, 4, 5, &a (2, 3), a.cols (), &b (1, 2), b.cols (), &c (1, 1), c.cols ());
+  for (int i = 0; i < 6; i++)
+    for (int l = 0; l < 9; l++)
+      {
+        Element expected = zero_element ();
+        if (i >= 1 && i < 4 && l >= 1 && l < 6)
+          for (int j = 0; j < 4; j++)
+            expected += a (i + 1, j + 3) * b (j + 1, l + 1);
+        if (c (i, l) != expected)
+          {
+            printf ("SECTION RESULT: GEMM: ERROR: submatrix product is wrong\n");
+            return false;
+          }
+      }
+  printf ("  leading dimensions : OK\n");
+
+  printf ("SECTION RESULT: GEMM: OK!\n");
+  return true;
+}
+
+static bool run_greased_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: GREASED\n");
+
+  // widths that end inside a table and row counts that end inside a group
+  const int sizes[][3] = {{1, 1, 1}, {5, 3, 17}, {130, 7, 300}, {9, 130, 129}};
+  for (const auto &size : sizes)
+    {
+      const int m = size[0];
+      const int k = size[1];
+      const size_t n = size[2];
+      std::vector<Element> a (m * k), b (k * n), c (m * n);
+      fill_random (a);
+      fill_random (b);
+      fill_random (c);
+
+      for (bool accumulate : {false, true})
+        {
+          std::vector<Element> expected = c, result = c;
+          gemm (m, k, n, a.data (), k, b.data (), n, expected.data (), n, accumulate);
+          greased_multiply (m, k, n, a.data (), k, b.data (), n, result.data (), n, accumulate);
+          if (result != expected)
+            {
+              printf ("SECTION RESULT: GREASED: ERROR: %dx%d times %dx%d is wrong\n", m, k, k, static_cast<int> (n));
+              return false;
+            }
+        }
+    }
+  printf ("  greased_multiply : OK\n");
+
+  for (int n : {1, 6, 37, 150})
+    {
+      Matrix m (n, n);
+      std::vector<Element> values (n * n);
+      fill_random (values);
+      std::copy (values.begin (), values.end (), m.row (0));
+
+      auto plain = m.inverse (false);
+      auto greased = m.inverse ();
+      Matrix augmented (n, 2 * n);
+      for (int r = 0; r < n; r++)
+        {
+          std::copy (m.row (r), m.row (r) + n, augmented.row (r));
+          augmented (r, n + r) = neutral_mult_element ();
+        }
+      bool invertible = greased_eliminate (augmented.row (0), n, 2 * n, 2 * n);
+
+      bool ok = invertible == plain.has_value () && greased.has_value () == plain.has_value ();
+      if (ok && plain)
+        {
+          ok = *greased == *plain && m * *plain == Matrix::identity (n);
+          for (int r = 0; r < n && ok; r++)
+            ok = std::equal (augmented.row (r) + n, augmented.row (r) + 2 * n, plain->row (r));
+        }
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: GREASED: ERROR: inverse of %dx%d matrix is wrong\n", n, n);
+          return false;
+        }
+    }
+
+  // a dependent row at the end of a group, then one in the middle of a group
+  Matrix singular = cauchy_matrix (128, 128, 128);
+  Matrix dependent_middle = singular;
+  mul_region (Element (static_cast<unsigned char> (7)), singular.row (1), singular.row (3), 128);
+  std::fill (dependent_middle.row (66), dependent_middle.row (67), zero_element ());
+  add_region (dependent_middle.row (127), dependent_middle.row (66), 128);
+  add_region (dependent_middle.row (2), dependent_middle.row (66), 128);
+  if (singular.inverse () || dependent_middle.inverse () || !cauchy_matrix (128, 128, 128).inverse ())
+    {
+      printf ("SECTION RESULT: GREASED: ERROR: singular matrix was not detected\n");
+      return false;
+    }
+  printf ("  greased_eliminate, singular : OK\n");
+
+  printf ("SECTION RESULT: GREASED: OK!\n");
+  return true;
+}
+
+// rows x cols, a nonzero diagonal and about per_row other entries in every row
+static GF256::SparseMatrix random_sparse (int rows, int cols, int per_row)
+{
+  using namespace GF256;
+  std::vector<SparseMatrix::Entry> entries;
+  for (int r = 0; r < rows; r++)
+    {
+      if (r < cols)
+        entries.push_back ({r, r, Element (static_cast<unsigned char> (1 + std::rand () % 255))});
+      for (int e = 0; e < per_row; e++)
+        entries.push_back ({r, std::rand () % cols, Element (static_cast<unsigned char> (std::rand () % 256))});
+    }
+  return SparseMatrix (rows, cols, entries);
+}
+
+static bool run_sparse_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: SPARSE\n");
+
+  const size_t len = 100;
+  for (int n : {1, 10, 60, 200})
+    {
+      SparseMatrix a = random_sparse (n + 3, n, 3);
+      Matrix dense = a.to_dense ();
+      bool ok = SparseMatrix::from_dense (dense) == a && a.transpose ().transpose () == a;
+      for (int r = 0; r < a.rows () && ok; r++)
+        for (int c = 0; c < n && ok; c++)
+          ok = a (r, c) == dense (r, c) && a.transpose () (c, r) == dense (r, c);
+
+      // products against the dense ones
+      std::vector<Element> x (n), y (a.rows ()), expected_y (a.rows ());
+      fill_random (x);
+      a.multiply (x.data (), y.data ());
+      gemm (a.rows (), n, 1, dense.row (0), n, x.data (), 1, expected_y.data (), 1);
+      ok = ok && y == expected_y;
+
+      Shards solutions = make_shards (n, len), payloads = make_shards (a.rows (), len);
+      for (auto &solution : solutions)
+        fill_random (solution);
+      std::vector<const Element *> solution_ptrs;
+      for (auto &solution : solutions)
+        solution_ptrs.push_back (solution.data ());
+      std::vector<Element *> payload_ptrs = shard_pointers (payloads);
+      a.multiply (solution_ptrs.data (), payload_ptrs.data (), len);
+
+      Shards expected_payloads = make_shards (a.rows (), len);
+      gemm (a.rows (), n, len, dense.row (0), n, solution_ptrs.data (), shard_pointers (expected_payloads).data ());
+      ok = ok && payloads == expected_payloads;
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: SPARSE: ERROR: %dx%d sparse matrix does not match the dense one\n", a.rows (), n);
+          return false;
+        }
+
+      // all dense, switching to dense on the way, all sparse
+      std::vector<const Element *> const_payload_ptrs (payload_ptrs.begin (), payload_ptrs.end ());
+      for (double dense_density : {0.0, 0.1, 2.0})
+        {
+          Shards solved = make_shards (n, len);
+          bool solvable = sparse_solve (a, const_payload_ptrs.data (), shard_pointers (solved).data (), len, dense_density);
+          if (solvable != (dense.rank () == n) || (solvable && solved != solutions))
+            {
+              printf ("SECTION RESULT: SPARSE: ERROR: %dx%d system is solved wrong\n", a.rows (), n);
+              return false;
+            }
+        }
+    }
+  printf ("  CSR, transpose, multiply, sparse_solve : OK\n");
+
+  // a column without nonzeros
+  SparseMatrix deficient (3, 3, {{0, 0, neutral_mult_element ()}, {1, 0, neutral_mult_element ()}, {2, 1, neutral_mult_element ()}});
+  Shards payloads = make_shards (3, len), solved = make_shards (3, len);
+  std::vector<const Element *> payload_ptrs;
+  for (auto &payload : payloads)
+    payload_ptrs.push_back (payload.data ());
+  if (sparse_solve (deficient, payload_ptrs.data (), shard_pointers (solved).data (), len)
+      || sparse_solve (deficient, payload_ptrs.data (), shard_pointers (solved).data (), len, 0.0))
+    {
+      printf ("SECTION RESULT: SPARSE: ERROR: rank deficient system was solved\n");
+      return false;
+    }
+  printf ("  rank deficient : OK\n");
+
+  printf ("SECTION RESULT: SPARSE: OK!\n");
+  return true;
+}
+
+template <class Field>
+static bool check_tower_field (const char *name)
+{
+  using namespace GF256;
+  using Rep = typename Field::rep_type;
+
+  auto random_element = [] ()
+  {
+    Rep rep = 0;
+    for (int b = 0; b < Field::degree; b++)
+      rep |= static_cast<Rep> (std::rand () % 256) << (8 * b);
+    return Field::from_rep (rep);
+  };
+
+  const Field one = Field::from_rep (1);
+  const uint64_t order = (uint64_t (1) << (8 * Field::degree)) - 1;
+  for (int t = 0; t < 2000; t++)
+    {
+      Field a = random_element ();
+      Field b = random_element ();
+      Field c = random_element ();
+      bool ok = Field::from_rep (a.rep ()) == a && a * (b + c) == a * b + a * c && (a * b) * c == a * (b * c)
+                && a * b == b * a && a * one == a;
+      if (a != Field ())
+        ok = ok && a * a.inv () == one && (b / a) * a == b && a.pow (order) == one;
+      if (a != Field () && b != Field ())
+        ok = ok && a * b != Field ();
+
+      if (!ok)
+        {
+          printf ("SECTION RESULT: TOWER: ERROR: %s arithmetic is wrong\n", name);
+          return false;
+        }
+    }
+
+  // the plane kernels against symbol by symbol products
+  const size_t symbols = 100;
+  const size_t len = symbols * Field::degree;
+  std::vector<Element> src (len), dst (len);
+  fill_random (src);
+  fill_random (dst);
+  std::vector<Element> product = dst, sum = dst;
+  Field coef = random_element ();
+  mul_region (coef, src.data (), product.data (), len);
+  mul_add_region (coef, src.data (), sum.data (), len);
+  for (size_t s = 0; s < symbols; s++)
+    {
+      auto symbol = [&] (const std::vector<Element> &buffer)
+      {
+        Rep rep = 0;
+        for (int p = 0; p < Field::degree; p++)
+          rep |= static_cast<Rep> (buffer[p * symbols + s].additive_rep ()) << (8 * p);
+        return Field::from_rep (rep);
+      };
+
+      if (symbol (product) != coef * symbol (src) || symbol (sum) != symbol (dst) + coef * symbol (src))
+        {
+          printf ("SECTION RESULT: TOWER: ERROR: %s plane kernels are wrong\n", name);
+          return false;
+        }
+    }
+
+  printf ("  %s arithmetic, plane kernels : OK\n", name);
+  return true;
+}
+
+template <class Field>
+static bool check_wide_reed_solomon (int k, int m, size_t len)
+{
+  using namespace GF256;
+
+  WideReedSolomon<Field> rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+  std::vector<Element *> ptrs = shard_pointers (shards);
+  rs.encode (ptrs.data (), ptrs.data () + k, len);
+  const Shards original = shards;
+
+  // parity shard 0 is the sum of the data shards times coefficients of the field
+  for (size_t s = 0; s < len / Field::degree; s++)
+    {
+      Field expected;
+      for (int j = 0; j < k; j++)
+        {
+          typename Field::rep_type rep = 0;
+          for (int p = 0; p < Field::degree; p++)
+            rep |= static_cast<typename Field::rep_type> (shards[j][p * len / Field::degree + s].additive_rep ()) << (8 * p);
+          expected += rs.coefficient (0, j) * Field::from_rep (rep);
+        }
+      for (int p = 0; p < Field::degree; p++)
+        if (shards[k][p * len / Field::degree + s] != Element (static_cast<unsigned char> (expected.rep () >> (8 * p))))
+          {
+            printf ("SECTION RESULT: TOWER: ERROR: RS(%d, %d) parity is wrong\n", k, m);
+            return false;
+          }
+    }
+
+  // lose m shards, data and parity
+  std::vector<bool> present (k + m, true);
+  for (int lost = 0; lost < m; lost++)
+    {
+      int shard = lost % 2 ? k + lost : lost * (k / m);
+      present[shard] = false;
+      std::fill (shards[shard].begin (), shards[shard].end (), zero_element ());
+    }
+
+  bool rebuilt = rs.reconstruct (ptrs.data (), present, len) && shards == original;
+
+  // one shard too many
+  present[1] = false;
+  if (!rebuilt || rs.reconstruct (ptrs.data (), present, len))
+    {
+      printf ("SECTION RESULT: TOWER: ERROR: RS(%d, %d) reconstruction is wrong\n", k, m);
+      return false;
+    }
+
+  printf ("  RS(%d, %d) over GF(2^%d) : OK\n", k, m, 8 * Field::degree);
+  return true;
+}
+
+static bool run_tower_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: TOWER\n");
+
+  // every nonzero element of GF65536 has an inverse
+  for (uint32_t rep = 1; rep < 65536; rep++)
+    {
+      GF65536 x = GF65536::from_rep (static_cast<uint16_t> (rep));
+      if (x * x.inv () != GF65536::from_rep (1))
+        {
+          printf ("SECTION RESULT: TOWER: ERROR: GF65536 inverse of %u is wrong\n", rep);
+          return false;
+        }
+    }
+
+  if (!check_tower_field<GF65536> ("GF65536") || !check_tower_field<GF2_32> ("GF2_32"))
+    return false;
+
+  if (!check_wide_reed_solomon<GF65536> (300, 20, 2 * 70) || !check_wide_reed_solomon<GF2_32> (20, 6, 4 * 33))
+    return false;
+
+  printf ("SECTION RESULT: TOWER: OK!\n");
+  return true;
+}
+
+static const char *basis_kernel_name (GF256::BasisKernel kernel)
+{
+  switch (kernel)
+    {
+    case GF256::BasisKernel::scalar:      return "scalar";
+    case GF256::BasisKernel::pshufb:      return "pshufb";
+    case GF256::BasisKernel::gfni:        return "gfni";
+    case GF256::BasisKernel::gfni_avx512: return "gfni_avx512";
+    }
+  return "";
+}
+
+static const GF256::BasisKernel basis_kernels[] = {GF256::BasisKernel::scalar, GF256::BasisKernel::pshufb,
+                                                    GF256::BasisKernel::gfni, GF256::BasisKernel::gfni_avx512};
+
+static bool run_basis_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: BASIS\n");
+
+  static_assert (basis_impl::mul (0x53, 0xca, aes_polynomial) == 1);
+  static_assert (basis_conversion (gf256_polynomial, gf256_polynomial) == BitMatrix {{1, 2, 4, 8, 16, 32, 64, 128}});
+
+  const std::pair<unsigned, unsigned char> polynomials[] = {{gf256_polynomial, 2}, {aes_polynomial, 3}, {raid6_polynomial, 2}};
+  for (auto [polynomial, generator_rep] : polynomials)
+    {
+      BitMatrix to = basis_to_gf256 (polynomial);
+      for (int a = 0; a < 256; a++)
+        for (int b = 0; b < 256; b++)
+          {
+            auto x = static_cast<unsigned char> (a);
+            auto y = static_cast<unsigned char> (b);
+            Element product = Element (apply (to, x)) * Element (apply (to, y));
+            if (Element (apply (to, basis_impl::mul (x, y, polynomial))) != product
+                || apply (to, x ^ y) != (apply (to, x) ^ apply (to, y)))
+              {
+                printf ("SECTION RESULT: BASIS: ERROR: conversion from 0x%x is not an isomorphism\n", polynomial);
+                return false;
+              }
+          }
+
+      // the usual generator of each representation maps to a generator of ours
+      Element generator (apply (to, generator_rep));
+      int order = 1;
+      for (Element power = generator; power != neutral_mult_element (); power *= generator)
+        order++;
+      if (order != 255)
+        {
+          printf ("SECTION RESULT: BASIS: ERROR: 0x%x maps its generator to an element of order %d\n", polynomial, order);
+          return false;
+        }
+    }
+
+  BitMatrix aes_to_raid6 = basis_conversion (aes_polynomial, raid6_polynomial);
+  for (int a = 0; a < 256; a++)
+    for (int b = 0; b < 256; b++)
+      {
+        auto x = static_cast<unsigned char> (a);
+        auto y = static_cast<unsigned char> (b);
+        if (apply (aes_to_raid6, basis_impl::mul (x, y, aes_polynomial))
+            != basis_impl::mul (apply (aes_to_raid6, x), apply (aes_to_raid6, y), raid6_polynomial))
+          {
+            printf ("SECTION RESULT: BASIS: ERROR: conversion from 0x11b to 0x11d is wrong\n");
+            return false;
+          }
+      }
+  printf ("  isomorphisms : OK\n");
+
+  const Element coef (static_cast<unsigned char> (0x9d));
+  for (BasisKernel kernel : basis_kernels)
+    {
+      if (!basis_kernel_supported (kernel))
+        {
+          printf ("  %s : not supported by this CPU\n", basis_kernel_name (kernel));
+          continue;
+        }
+
+      for (size_t len : {0, 5, 16, 63, 64, 200, 4099})
+        {
+          std::vector<Element> src (len);
+          std::vector<Element> other (len);
+          fill_random (src);
+          fill_random (other);
+
+          std::vector<unsigned char> aes (len);
+          std::vector<Element> back (len);
+          to_basis (aes_polynomial, src.data (), aes.data (), len, kernel);
+          from_basis (aes_polynomial, aes.data (), back.data (), len, kernel);
+
+          bool ok = back == src;
+          BitMatrix to_aes = basis_from_gf256 (aes_polynomial);
+          for (size_t i = 0; i < len; i++)
+            ok = ok && aes[i] == apply (to_aes, src[i].additive_rep ());
+
+          std::vector<Element> product (len);
+          affine_mul_region (coef, src.data (), product.data (), len, kernel);
+          for (size_t i = 0; i < len; i++)
+            ok = ok && product[i] == coef * src[i];
+
+          mul_lanes (src.data (), other.data (), product.data (), len, kernel);
+          for (size_t i = 0; i < len; i++)
+            ok = ok && product[i] == src[i] * other[i];
+
+          if (!ok)
+            {
+              printf ("SECTION RESULT: BASIS: ERROR: %s kernel is wrong for len %d\n",
+                      basis_kernel_name (kernel), static_cast<int> (len));
+              return false;
+            }
+        }
+
+      printf ("  %s : OK\n", basis_kernel_name (kernel));
+    }
+
+  printf ("SECTION RESULT: BASIS: OK!\n");
+  return true;
+}
+
+static const char *jit_kernel_name (GF256::JitKernel kernel)
+{
+  switch (kernel)
+    {
+    case GF256::JitKernel::none:  return "fallback";
+    case GF256::JitKernel::ssse3: return "ssse3";
+    case GF256::JitKernel::avx2:  return "avx2";
+    }
+  return "";
+}
+
+static bool run_jit_encoder_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: JIT ENCODER\n");
+
+  const int configs[][2] = {{8, 3}, {12, 4}, {4, 8}, {3, 2}};
+  for (const auto &config : configs)
+    {
+      const int k = config[0];
+      const int m = config[1];
+      ReedSolomon rs (k, m);
+
+      // a matrix with zero and one coefficients exercises the special cases of the generator
+      std::vector<Element> coefs (rs.encode_matrix ().row (k), rs.encode_matrix ().row (k) + k * m);
+      coefs[0] = zero_element ();
+      coefs[1] = neutral_mult_element ();
+
+      for (JitKernel kernel : {JitKernel::none, JitKernel::ssse3, JitKernel::avx2})
+        {
+          if (!jit_kernel_supported (kernel))
+            continue;
+
+          JitEncoder rs_jit (rs.encode_matrix ().row (k), k, m, kernel);
+          JitEncoder special_jit (coefs.data (), k, m, kernel);
+          if (rs_jit.kernel () != (m <= 8 ? kernel : JitKernel::none))
+            {
+              printf ("SECTION RESULT: JIT ENCODER: ERROR: RS(%d, %d) %s kernel was not generated\n", k, m,
+                      jit_kernel_name (kernel));
+              return false;
+            }
+
+          for (size_t len : {0, 15, 16, 1000, 4096, 4099})
+            {
+              Shards data = make_shards (k, len);
+              Shards expected = make_shards (m, len);
+              Shards actual = make_shards (m, len);
+              for (auto &shard : data)
+                fill_random (shard);
+
+              std::vector<const Element *> srcs;
+              for (auto &shard : data)
+                srcs.push_back (shard.data ());
+              std::vector<Element *> expected_ptrs = shard_pointers (expected);
+              std::vector<Element *> actual_ptrs = shard_pointers (actual);
+
+              rs.encode (srcs.data (), expected_ptrs.data (), len);
+              rs_jit.run (srcs.data (), actual_ptrs.data (), len);
+              bool ok = expected == actual;
+
+              for (int o = 0; o < m; o++)
+                dot_product (coefs.data () + o * k, srcs.data (), k, expected_ptrs[o], len);
+              special_jit.run (srcs.data (), actual_ptrs.data (), len);
+              ok = ok && expected == actual;
+
+              if (!ok)
+                {
+                  printf ("SECTION RESULT: JIT ENCODER: ERROR: RS(%d, %d) %s kernel differs for len %d\n",
+                          k, m, jit_kernel_name (kernel), static_cast<int> (len));
+                  return false;
+                }
+            }
+        }
+
+      printf ("  RS(%d, %d) : OK\n", k, m);
+    }
+
+  for (JitKernel kernel : {JitKernel::ssse3, JitKernel::avx2})
+    if (!jit_kernel_supported (kernel))
+      printf ("  %s : not supported by this CPU\n", jit_kernel_name (kernel));
+
+  printf ("SECTION RESULT: JIT ENCODER: OK!\n");
+  return true;
+}
+
+// In-process stand-in for n storage nodes: every shard and every repair fragment crosses
+// the "network" through send (), which counts the bytes.
+struct LoopbackCluster
+{
+  Shards node_shards;
+  size_t bytes_sent = 0;
+
+  LoopbackCluster (int nodes, size_t shard_len) : node_shards (make_shards (nodes, shard_len)) {}
+
+  const GF256::Element *send (const GF256::Element *data, size_t len)
+  {
+    bytes_sent += len;
+    return data;
+  }
+};
+
+// Regenerates node failed of a product-matrix MSR cluster from helper nodes next to it.
+static void msr_regenerate (const GF256::ProductMatrixMSR &msr, LoopbackCluster &cluster, int failed,
+                            Shards &fragments, std::vector<GF256::Element> &newcomer, size_t len)
+{
+  std::vector<int> helpers;
+  std::vector<const GF256::Element *> received;
+  for (int j = 1; static_cast<int> (helpers.size ()) < msr.helpers (); j++)
+    {
+      int helper = (failed + j) % msr.nodes ();
+      msr.helper_fragment (failed, cluster.node_shards[helper].data (), fragments[helpers.size ()].data (), len);
+      received.push_back (cluster.send (fragments[helpers.size ()].data (), len));
+      helpers.push_back (helper);
+    }
+
+  msr.regenerate (failed, helpers, received.data (), newcomer.data (), len);
+}
+
+static bool run_msr_section ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: MSR\n");
+
+  for (int k = 2; k <= 6; k++)
+    {
+      int n = 2 * k + 1;
+      const size_t len = 512 + 9;
+      ProductMatrixMSR msr (n, k);
+
+      std::vector<Element> message (msr.message_symbols () * len);
+      fill_random (message);
+
+      LoopbackCluster cluster (n, msr.alpha () * len);
+      std::vector<Element *> pointers = shard_pointers (cluster.node_shards);
+      msr.encode (message.data (), pointers.data (), len);
+
+      Shards fragments = make_shards (msr.helpers (), len);
+      std::vector<Element> newcomer (msr.alpha () * len);
+      for (int failed = 0; failed < n; failed++)
+        {
+          cluster.bytes_sent = 0;
+          msr_regenerate (msr, cluster, failed, fragments, newcomer, len);
+          if (newcomer != cluster.node_shards[failed] || cluster.bytes_sent != msr.helpers () * len)
+            {
+              printf ("SECTION RESULT: MSR: ERROR: regeneration of node %d in (%d, %d) is wrong\n", failed, n, k);
+              return false;
+            }
+        }
+
+      for (int first = 0; first < n; first++)
+        {
+          std::vector<int> sources;
+          std::vector<const Element *> shards;
+          for (int i = 0; i < k; i++)
+            {
+              sources.push_back ((first + 2 * i) % n);
+              shards.push_back (cluster.node_shards[sources.back ()].data ());
+            }
+
+          std::vector<Element> decoded (message.size ());
+          if (!msr.reconstruct (sources, shards.data (), decoded.data (), len) || decoded != message)
+            {
+              printf ("SECTION RESULT: MSR: ERROR: reconstruction from node %d in (%d, %d) is wrong\n", first, n, k);
+              return false;
+            }
+        }
+
+      printf ("  MSR(n = %d, k = %d, d = %d) regenerate, reconstruct : OK\n", n, k, msr.helpers ());
+    }
+
+  printf ("SECTION RESULT: MSR: OK!\n");
+  return true;
+}
 
 bool GF256::run_test_suit ()
 {
-  printf ("=================================TEST SUIT=================================\n");
+  printf ("=================================TEST SUIT=================================\n");
+
+  Element root = GF256::primitive_root ();
+
+  std::unordered_set<Element> power_elements;
+  std::unordered_set<Element> inverse_elements;
+
+  printf ("SECTION: POWER\n");
+  for (int i = 0; i < 255; i++)
+    {
+      Element power = root.pow (i);
+
+      printf ("  x^%d = %s\n", i, to_string_as_polynom (power).c_str ());
+
+      auto it = power_elements.find (power);
+      if (it != power_elements.end ())
+        {
+          printf ("SECTION RESULT: POWER: ERROR: x is not a generator of a multiplicative group!\n");
+          return false;
+        }
+
+      power_elements.insert (power);
+    }
+
+  printf ("SECTION RESULT: POWER: OK!\n");
+
+  printf ("SECTION: MULTIPLICATION\n");
+
+  inverse_elements.clear ();
+
+  Element prod = GF256::neutral_mult_element ();
+
+  for (int i = 1; i <= 255; i++)
+    {
+      Element prev_prod = prod;
+      printf ("  x^%d = (%s) * x = %s", i,
+              to_string_as_polynom (prev_prod).c_str (),
+              to_string_as_polynom (prod *= root).c_str ());
+
+      if (root.pow (i) != prod)
+        {
+          printf (" : ERROR\n");
+          printf ("SECTION RESULT: MULTIPLICATION: ERROR: multiplication produced wrong result\n");
+          return false;
+        }
+      else
+        printf (" : OK\n");
+      }
+
+  printf ("SECTION RESULT: MULTIPLICATION: OK!\n");
+
+  printf ("SECTION: INVERSE\n");
+  for (auto &&element : power_elements)
+    {
+      Element inverse = element.inv ();
+      Element prod = element * inverse;
+      printf ("  (%s)^-1 = %s\n", to_string_as_polynom (element).c_str (), to_string_as_polynom (inverse).c_str ());
+      printf ("  (%s) * (%s) = %s",
+              to_string_as_polynom (element).c_str (),
+              to_string_as_polynom (inverse).c_str (),
+              to_string_as_polynom (prod).c_str ());
+
+      if (prod == neutral_mult_element ())
+        printf (" : OK!\n");
+      else
+        {
+          printf (" : ERROR!\n");
+          printf ("SECTION RESULT: INVERSE: ERROR: inverse * base != 1\n");
+          return false;
+        }
+
+      auto it = inverse_elements.find (inverse);
+      if (it != inverse_elements.end ())
+        {
+          printf ("SECTION RESULT: INVERSE: ERROR: inverse operation is not biective\n");
+          return false;
+        }
+
+      inverse_elements.insert (inverse);
+    }
+
+  printf ("SECTION: DIVISION\n");
+
+  Element div = GF256::neutral_mult_element ();
+  Element inverse_root = root.inv ();
+  for (int i = 1; i <= 255; i++)
+    {
+      Element prev_div = div;
+      printf ("  x^-%d = (%s) / x = %s", i,
+              to_string_as_polynom (prev_div).c_str (),
+              to_string_as_polynom (div /= root).c_str ());
+
+      if (inverse_root.pow (i) != div)
+        {
+          printf (" : ERROR\n");
+          printf ("SECTION RESULT: DIVISION: ERROR: division produced wrong result\n");
+          return false;
+        }
+      else
+        printf (" : OK\n");
+    }
+
+  printf ("SECTION RESULT: DIVISION: OK!\n");
+
+  printf ("SECTION: ADDITION\n");
+
+  for (int max_i = 1; max_i <= 254; max_i++)
+    {
+      Element sum;
+      for (int i = 0; i <= max_i; i++)
+        sum += root.pow (i);
+
+      Element power = root.pow (max_i + 1);
+      Element numerator = power - 1;
+      Element denomenator = root - 1;
+
+      Element must_be_sum = numerator / denomenator;
+      printf ("  1 + ... + x^%d = %s", max_i, to_string_as_polynom (sum).c_str ());
+
+      if (sum != must_be_sum)
+        {
+          printf (" : ERROR\n");
+          printf ("SECTION RESULT: ADDITION: ERROR: addition produced wrong result\n");
+          return false;
+        }
+      else
+        printf (" : OK\n");
+    }
+
+  printf ("SECTION RESULT: ADDITION: OK!\n");
+
+  if (!run_bulk_section ())
+    return false;
+
+  if (!run_matrix_section ())
+    return false;
+
+  if (!run_reed_solomon_section ())
+    return false;
+
+  if (!run_lrc_section ())
+    return false;
+
+  if (!run_msr_section ())
+    return false;
+
+  if (!run_stream_encoder_section ())
+    return false;
+
+  if (!run_shard_io_section ())
+    return false;
+
+  if (!run_file_modes_section ())
+    return false;
+
+  if (!run_async_codec_section ())
+    return false;
+
+  if (!run_jit_encoder_section ())
+    return false;
+
+  if (!run_fixed_reed_solomon_section ())
+    return false;
+
+  if (!run_bitmatrix_section ())
+    return false;
+
+  if (!run_bitplane_section ())
+    return false;
+
+  if (!run_constant_time_section ())
+    return false;
+
+  if (!run_clmul_section ())
+    return false;
+
+  if (!run_vec_section ())
+    return false;
+
+  if (!run_buffer_section ())
+    return false;
+
+  if (!run_gemm_section ())
+    return false;
+
+  if (!run_greased_section ())
+    return false;
+
+  if (!run_sparse_section ())
+    return false;
+
+  if (!run_tower_section ())
+    return false;
+
+  if (!run_basis_section ())
+    return false;
+
+  return true;
+}
+
+static void run_repair_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 12;
+  const int l = 2;
+  const int r = 2;
+  const size_t len = 1 << 20;
+  const int repairs = 200;
+
+  printf ("SECTION: LRC REPAIR\n");
+  printf ("  Repairing a lost data shard %d times, LRC(%d, %d, %d) vs RS(%d, %d), 1 MiB shards\n",
+          repairs, k, l, r, k, l + r);
+
+  LRC lrc (k, l, r);
+  ReedSolomon rs (k, l + r);
+
+  Shards lrc_shards = make_shards (lrc.total_shards (), len);
+  Shards rs_shards = make_shards (rs.total_shards (), len);
+  for (int i = 0; i < k; i++)
+    {
+      fill_random (lrc_shards[i]);
+      rs_shards[i] = lrc_shards[i];
+    }
+
+  std::vector<Element *> lrc_pointers = shard_pointers (lrc_shards);
+  std::vector<Element *> rs_pointers = shard_pointers (rs_shards);
+  lrc.encode (lrc_pointers.data (), lrc_pointers.data () + k, len);
+  rs.encode (rs_pointers.data (), rs_pointers.data () + k, len);
+
+  std::vector<bool> present (rs.total_shards (), true);
+  present[0] = false;
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int i = 0; i < repairs; i++)
+    lrc.repair (0, lrc_pointers.data (), len);
+  auto lrc_dif = clock.now () - begin;
+
+  begin = clock.now ();
+  for (int i = 0; i < repairs; i++)
+    rs.reconstruct (rs_pointers.data (), present, len);
+  auto rs_dif = clock.now () - begin;
+
+  printf ("  LRC bytes read per repair: %zu\n", lrc.repair_sources (0).size () * len);
+  printf ("  RS bytes read per repair: %zu\n", static_cast<size_t> (k) * len);
+  printf ("  LRC time: %d\n", get_msecs (lrc_dif));
+  printf ("  RS time: %d\n", get_msecs (rs_dif));
+}
+
+static void run_regenerating_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 6;
+  const int n = 12;
+  const size_t len = 1 << 18;
+  const int repairs = 100;
+
+  ProductMatrixMSR msr (n, k);
+  ReedSolomon rs (k, n - k);
+  size_t shard_len = msr.alpha () * len;
+
+  printf ("SECTION: MSR REPAIR\n");
+  printf ("  Regenerating a lost node %d times, MSR(n = %d, k = %d, d = %d) vs RS(%d, %d), %zu KiB per node\n",
+          repairs, n, k, msr.helpers (), k, n - k, shard_len >> 10);
+
+  std::vector<Element> message (msr.message_symbols () * len);
+  fill_random (message);
+
+  LoopbackCluster msr_cluster (n, shard_len);
+  std::vector<Element *> msr_pointers = shard_pointers (msr_cluster.node_shards);
+  msr.encode (message.data (), msr_pointers.data (), len);
+
+  LoopbackCluster rs_cluster (n, shard_len);
+  for (int i = 0; i < k; i++)
+    std::copy (message.begin () + i * shard_len, message.begin () + (i + 1) * shard_len, rs_cluster.node_shards[i].begin ());
+  std::vector<Element *> rs_pointers = shard_pointers (rs_cluster.node_shards);
+  rs.encode (rs_pointers.data (), rs_pointers.data () + k, shard_len);
+
+  Shards fragments = make_shards (msr.helpers (), len);
+  std::vector<Element> newcomer (shard_len);
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int i = 0; i < repairs; i++)
+    msr_regenerate (msr, msr_cluster, 0, fragments, newcomer, len);
+  auto msr_dif = clock.now () - begin;
+
+  std::vector<bool> present (n, true);
+  present[0] = false;
+  Shards received = make_shards (n, shard_len);
+  std::vector<Element *> received_pointers = shard_pointers (received);
+
+  begin = clock.now ();
+  for (int i = 0; i < repairs; i++)
+    {
+      for (int j = 1; j <= k; j++)
+        memcpy (received_pointers[j], rs_cluster.send (rs_pointers[j], shard_len), shard_len);
+      rs.reconstruct (received_pointers.data (), present, shard_len);
+    }
+  auto rs_dif = clock.now () - begin;
+
+  printf ("  MSR bytes sent per repair: %zu\n", msr_cluster.bytes_sent / repairs);
+  printf ("  RS bytes sent per repair: %zu\n", rs_cluster.bytes_sent / repairs);
+  printf ("  MSR time: %d\n", get_msecs (msr_dif));
+  printf ("  RS time: %d\n", get_msecs (rs_dif));
+}
+
+static void run_partial_write_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 10;
+  const int m = 4;
+  const size_t len = 1 << 20;
+  const size_t write_len = 4096;
+  const int writes = 200;
+
+  printf ("SECTION: PARTIAL WRITE\n");
+  printf ("  Overwriting 4 KiB of a 1 MiB data shard %d times, RS(%d, %d)\n", writes, k, m);
+
+  ReedSolomon rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+
+  std::vector<Element *> pointers = shard_pointers (shards);
+  std::vector<Element> new_data (write_len);
+  std::vector<Element> old_data (write_len);
+  fill_random (new_data);
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int i = 0; i < writes; i++)
+    {
+      size_t offset = (i * 7919 * write_len) % (len - write_len);
+      std::copy (shards[3].begin () + offset, shards[3].begin () + offset + write_len, old_data.begin ());
+      std::copy (new_data.begin (), new_data.end (), shards[3].begin () + offset);
+      rs.update_parity (3, offset, old_data.data (), new_data.data (), write_len, pointers.data () + k);
+    }
+  auto update_dif = clock.now () - begin;
+
+  begin = clock.now ();
+  for (int i = 0; i < writes; i++)
+    {
+      size_t offset = (i * 7919 * write_len) % (len - write_len);
+      std::copy (new_data.begin (), new_data.end (), shards[3].begin () + offset);
+      rs.encode (pointers.data (), pointers.data () + k, len);
+    }
+  auto encode_dif = clock.now () - begin;
+
+  printf ("  update_parity time: %d\n", get_msecs (update_dif));
+  printf ("  full re-encode time: %d\n", get_msecs (encode_dif));
+}
+
+static void run_degraded_read_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 10;
+  const int m = 4;
+  const size_t len = 1 << 20;
+  const size_t read_len = 4096;
+  const int reads = 200;
+
+  printf ("SECTION: DEGRADED READ\n");
+  printf ("  Reading 4 KiB of a lost 1 MiB data shard %d times, RS(%d, %d)\n", reads, k, m);
+
+  ReedSolomon rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+
+  std::vector<Element *> pointers = shard_pointers (shards);
+  rs.encode (pointers.data (), pointers.data () + k, len);
+
+  std::vector<bool> present (k + m, true);
+  present[5] = false;
+  std::vector<Element> window (read_len);
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int i = 0; i < reads; i++)
+    {
+      size_t offset = (i * 7919 * read_len) % (len - read_len);
+      rs.reconstruct_range (pointers.data (), present, 5, offset, read_len, window.data ());
+      doNotOptimizeAway (window[0]);
+    }
+  auto range_dif = clock.now () - begin;
+
+  begin = clock.now ();
+  for (int i = 0; i < reads; i++)
+    {
+      rs.reconstruct (pointers.data (), present, len);
+      doNotOptimizeAway (shards[5][0]);
+    }
+  auto full_dif = clock.now () - begin;
+
+  printf ("  reconstruct_range time: %d\n", get_msecs (range_dif));
+  printf ("  whole shard reconstruct time: %d\n", get_msecs (full_dif));
+}
+
+static void run_scrub_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 10;
+  const int m = 4;
+  const size_t len = 1 << 20;
+  const int stripes = 200;
+
+  printf ("SECTION: SCRUB\n");
+  printf ("  Scrubbing a consistent RS(%d, %d) stripe of 1 MiB shards %d times\n", k, m, stripes);
+
+  ReedSolomon rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+
+  std::vector<Element *> pointers = shard_pointers (shards);
+  std::vector<const Element *> const_pointers (pointers.begin (), pointers.end ());
+  rs.encode (pointers.data (), pointers.data () + k, len);
+
+  Shards scratch = make_shards (m, len);
+  std::vector<Element *> scratch_pointers = shard_pointers (scratch);
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int i = 0; i < stripes; i++)
+    doNotOptimizeAway (rs.verify (const_pointers.data (), const_pointers.data () + k, len).ok);
+  auto verify_dif = clock.now () - begin;
+
+  begin = clock.now ();
+  for (int i = 0; i < stripes; i++)
+    {
+      rs.encode (pointers.data (), scratch_pointers.data (), len);
+      bool ok = true;
+      for (int j = 0; j < m; j++)
+        ok = ok && scratch[j] == shards[k + j];
+      doNotOptimizeAway (ok);
+    }
+  auto encode_dif = clock.now () - begin;
+
+  printf ("  verify time: %d\n", get_msecs (verify_dif));
+  printf ("  re-encode and compare time: %d\n", get_msecs (encode_dif));
+}
+
+static void run_checksummed_encode_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 10;
+  const int m = 4;
+  const size_t len = 1 << 20;
+  const int stripes = 200;
+
+  printf ("SECTION: CHECKSUMMED ENCODE\n");
+  printf ("  Encoding and checksumming an RS(%d, %d) stripe of 1 MiB shards %d times\n", k, m, stripes);
+
+  ReedSolomon rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+
+  std::vector<Element *> pointers = shard_pointers (shards);
+  std::vector<uint32_t> crcs (k + m);
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int i = 0; i < stripes; i++)
+    {
+      rs.encode (pointers.data (), pointers.data () + k, len, crcs.data (), crcs.data () + k);
+      doNotOptimizeAway (crcs[0]);
+    }
+  auto fused_dif = clock.now () - begin;
+
+  begin = clock.now ();
+  for (int i = 0; i < stripes; i++)
+    {
+      for (int j = 0; j < k; j++)
+        crcs[j] = crc32c (pointers[j], len);
+      rs.encode (pointers.data (), pointers.data () + k, len);
+      for (int j = k; j < k + m; j++)
+        crcs[j] = crc32c (pointers[j], len);
+      doNotOptimizeAway (crcs[0]);
+    }
+  auto separate_dif = clock.now () - begin;
+
+  printf ("  fused encode time: %d\n", get_msecs (fused_dif));
+  printf ("  checksum pass + encode time: %d\n", get_msecs (separate_dif));
+}
+
+static void run_stream_encoder_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 10;
+  const int m = 4;
+  const size_t shard_len = 64 << 10;
+  const size_t chunk_len = 16 << 10;
+  const size_t stream_len = 256 << 20;
+
+  printf ("SECTION: STREAM ENCODER\n");
+  printf ("  Encoding a 256 MiB stream in 16 KiB chunks, RS(%d, %d), 64 KiB shards, ring of 4 stripes\n", k, m);
+
+  ReedSolomon rs (k, m);
+  std::vector<Element> chunk (chunk_len);
+  fill_random (chunk);
+
+  chr::steady_clock clock;
+
+  size_t emitted = 0;
+  auto begin = clock.now ();
+  {
+    StreamEncoder encoder (rs, shard_len, 4, [&] (const StreamEncoder::Stripe &stripe)
+      {
+        emitted += stripe.data_len;
+      });
+
+    for (size_t done = 0; done < stream_len; done += chunk_len)
+      encoder.write (chunk.data (), chunk_len);
+  }
+  auto stream_dif = clock.now () - begin;
+
+  // batch: the same bytes, already in memory
+  Shards shards = make_shards (k + m, shard_len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+  std::vector<Element *> pointers = shard_pointers (shards);
+
+  begin = clock.now ();
+  for (size_t done = 0; done < stream_len; done += k * shard_len)
+    rs.encode (pointers.data (), pointers.data () + k, shard_len);
+  auto batch_dif = clock.now () - begin;
+
+  doNotOptimizeAway (emitted);
+  printf ("  StreamEncoder time: %d\n", get_msecs (stream_dif));
+  printf ("  batch encode time: %d\n", get_msecs (batch_dif));
+}
+
+static void run_shard_io_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 10;
+  const int m = 4;
+  const size_t shard_len = 256 << 10;
+  const int stripes = 200;
+
+  printf ("SECTION: SHARD IO\n");
+  printf ("  Encoding and writing %d RS(%d, %d) stripes of 256 KiB shards to /dev/shm\n", stripes, k, m);
+
+  char dir[] = "/dev/shm/gf256-bench-XXXXXX";
+  if (!mkdtemp (dir))
+    {
+      printf ("  /dev/shm is not available, skipped\n");
+      return;
+    }
+
+  ReedSolomon rs (k, m);
+  std::vector<std::vector<AlignedBuffer>> buffers (2);
+  std::vector<std::vector<Element *>> pointers (2);
+  for (int b = 0; b < 2; b++)
+    for (int i = 0; i < k + m; i++)
+      {
+        buffers[b].emplace_back (shard_len);
+        pointers[b].push_back (buffers[b].back ().data ());
+        if (i < k)
+          for (size_t j = 0; j < shard_len; j++)
+            pointers[b][i][j] = Element (static_cast<unsigned char> (std::rand () % 256));
+      }
+
+  auto shard_name = [&] (int i) {return std::string (dir) + "/shard." + std::to_string (i);};
+  chr::steady_clock clock;
+
+  for (ShardIO::Backend backend : {ShardIO::Backend::automatic, ShardIO::Backend::thread_pool})
+    {
+      ShardIO io (64, backend);
+      std::vector<int> fds;
+      for (int i = 0; i < k + m; i++)
+        fds.push_back (open_shard_file (shard_name (i), true));
+
+      uint64_t pending[2] = {0, 0};
+      auto begin = clock.now ();
+      for (int s = 0; s < stripes; s++)
+        {
+          int b = s % 2;
+          if (s >= 2)
+            io.wait (pending[b]);
+
+          rs.encode (pointers[b].data (), pointers[b].data () + k, shard_len);
+
+          std::vector<ShardIO::Request> requests;
+          for (int i = 0; i < k + m; i++)
+            requests.push_back ({fds[i], pointers[b][i], shard_len, s * shard_len, true});
+          pending[b] = io.submit (requests);
+        }
+      for (int s = std::max (0, stripes - 2); s < stripes; s++)
+        io.wait (pending[s % 2]);
+      auto dif = clock.now () - begin;
+
+      for (int fd : fds)
+        close (fd);
+
+      printf ("  %s time: %d\n", backend_name (io.backend ()), get_msecs (dif));
+    }
+
+  std::vector<int> fds;
+  for (int i = 0; i < k + m; i++)
+    fds.push_back (open_shard_file (shard_name (i), true));
+
+  auto begin = clock.now ();
+  for (int s = 0; s < stripes; s++)
+    {
+      rs.encode (pointers[0].data (), pointers[0].data () + k, shard_len);
+      for (int i = 0; i < k + m; i++)
+        if (pwrite (fds[i], pointers[0][i], shard_len, static_cast<off_t> (s * shard_len)) != static_cast<ssize_t> (shard_len))
+          printf ("  write failed\n");
+    }
+  auto sync_dif = clock.now () - begin;
+
+  for (int i = 0; i < k + m; i++)
+    {
+      close (fds[i]);
+      unlink (shard_name (i).c_str ());
+    }
+  rmdir (dir);
+
+  printf ("  synchronous write () time: %d\n", get_msecs (sync_dif));
+}
+
+static void run_async_codec_benchmark ()
+{
+  using namespace GF256;
 
-  Element root = GF256::primitive_root ();
+  const int k = 10;
+  const int m = 4;
+  const size_t len = 8 << 20;
+  const size_t chunk_len = 64 << 10;
 
-  std::unordered_set<Element> power_elements;
-  std::unordered_set<Element> inverse_elements;
+  printf ("SECTION: ASYNC CODEC\n");
+  printf ("  Encoding an RS(%d, %d) stripe of 8 MiB shards on an event loop, 64 KiB chunks\n", k, m);
 
-  printf ("SECTION: POWER\n");
-  for (int i = 0; i < 255; i++)
+  ReedSolomon rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+
+  std::vector<Element *> pointers = shard_pointers (shards);
+  std::vector<const Element *> data (pointers.begin (), pointers.begin () + k);
+  std::vector<Element *> parity (pointers.begin () + k, pointers.end ());
+
+  chr::steady_clock clock;
+  QueueExecutor executor;
+
+  Task<void> task = encode_async (executor, rs, data, parity, len, chunk_len);
+  chr::steady_clock::duration longest_step {};
+  auto begin = clock.now ();
+  task.start ();
+  longest_step = clock.now () - begin;
+  while (true)
     {
-      Element power = root.pow (i);
+      auto step_begin = clock.now ();
+      if (!executor.run_one ())
+        break;
+      longest_step = std::max (longest_step, clock.now () - step_begin);
+    }
+  auto async_dif = clock.now () - begin;
 
-      printf ("  x^%d = %s\n", i, to_string_as_polynom (power).c_str ());
+  begin = clock.now ();
+  rs.encode (pointers.data (), pointers.data () + k, len);
+  auto blocking_dif = clock.now () - begin;
+
+  printf ("  encode_async total time: %d\n", get_msecs (async_dif));
+  printf ("  encode_async longest event loop stall (usecs): %d\n",
+          static_cast<int> (chr::duration_cast<chr::microseconds> (longest_step).count ()));
+  printf ("  blocking encode stall (usecs): %d\n",
+          static_cast<int> (chr::duration_cast<chr::microseconds> (blocking_dif).count ()));
+}
 
-      auto it = power_elements.find (power);
-      if (it != power_elements.end ())
-        {
-          printf ("SECTION RESULT: POWER: ERROR: x is not a generator of a multiplicative group!\n");
-          return false;
-        }
+static void run_small_object_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 8;
+  const int m = 3;
+  const size_t len = 1 << 10;
+  const int stripes = 4096;
+  const int rounds = 50;
+
+  printf ("SECTION: SMALL OBJECTS\n");
+  printf ("  Encoding %d RS(%d, %d) stripes of 1 KiB shards %d times\n", stripes, k, m, rounds);
+
+  ReedSolomon rs (k, m);
+  Shards shards = make_shards (stripes * (k + m), len);
+  std::vector<Element *> data, parity;
+  for (int s = 0; s < stripes; s++)
+    for (int i = 0; i < k + m; i++)
+      {
+        if (i < k)
+          {
+            fill_random (shards[s * (k + m) + i]);
+            data.push_back (shards[s * (k + m) + i].data ());
+          }
+        else
+          parity.push_back (shards[s * (k + m) + i].data ());
+      }
 
-      power_elements.insert (power);
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    rs.encode_batch (data.data (), parity.data (), stripes, len);
+  auto batch_dif = clock.now () - begin;
+
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (int s = 0; s < stripes; s++)
+      rs.encode (data.data () + s * k, parity.data () + s * m, len);
+  auto encode_dif = clock.now () - begin;
+
+  // per-call table expansion, as with dot_product
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (int s = 0; s < stripes; s++)
+      for (int j = 0; j < m; j++)
+        dot_product (rs.encode_matrix ().row (k + j), data.data () + s * k, k, parity[s * m + j], len);
+  auto per_call_dif = clock.now () - begin;
+
+  // the same calls with the tables expanded once
+  const Tables &tables = rs.parity_tables ();
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (int s = 0; s < stripes; s++)
+      for (int j = 0; j < m; j++)
+        dot_product (tables.row (j), data.data () + s * k, k, parity[s * m + j], len);
+  auto expanded_dif = clock.now () - begin;
+
+  printf ("  encode_batch time: %d\n", get_msecs (batch_dif));
+  printf ("  encode per stripe time: %d\n", get_msecs (encode_dif));
+  printf ("  dot_product per parity time: %d\n", get_msecs (per_call_dif));
+  printf ("  dot_product per parity, expanded tables time: %d\n", get_msecs (expanded_dif));
+}
+
+static void run_jit_encoder_benchmark ()
+{
+  using namespace GF256;
+
+  const size_t len = 64 << 10;
+  const int rounds = 2000;
+
+  printf ("SECTION: JIT ENCODER\n");
+  printf ("  Encoding 64 KiB shards %d times with the generated kernel and with dot_product_multi\n", rounds);
+
+  const int configs[][2] = {{8, 3}, {12, 4}};
+  for (const auto &config : configs)
+    {
+      const int k = config[0];
+      const int m = config[1];
+      ReedSolomon rs (k, m);
+      JitEncoder jit (rs.encode_matrix ().row (k), k, m);
+      std::vector<NibbleTable> tables = make_nibble_tables (rs.encode_matrix ().row (k), k * m);
+
+      Shards shards = make_shards (k + m, len);
+      for (int i = 0; i < k; i++)
+        fill_random (shards[i]);
+      std::vector<Element *> pointers = shard_pointers (shards);
+      std::vector<const Element *> srcs (pointers.begin (), pointers.begin () + k);
+
+      chr::steady_clock clock;
+
+      auto begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        jit.run (srcs.data (), pointers.data () + k, len);
+      auto jit_dif = clock.now () - begin;
+
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        dot_product_multi (tables.data (), srcs.data (), k, pointers.data () + k, m, len);
+      auto template_dif = clock.now () - begin;
+
+      printf ("  RS(%d, %d) %s time: %d\n", k, m, jit.compiled () ? "jit" : "jit (fallback)", get_msecs (jit_dif));
+      printf ("  RS(%d, %d) dot_product_multi time: %d\n", k, m, get_msecs (template_dif));
     }
+}
 
-  printf ("SECTION RESULT: POWER: OK!\n");
+template <int K, int M>
+static void run_fixed_reed_solomon_benchmark (size_t len, int rounds)
+{
+  using namespace GF256;
 
-  printf ("SECTION: MULTIPLICATION\n");
+  ReedSolomon rs (K, M);
+  Shards shards = make_shards (K + M, len);
+  for (int i = 0; i < K; i++)
+    fill_random (shards[i]);
+  std::vector<Element *> pointers = shard_pointers (shards);
 
-  inverse_elements.clear ();
+  chr::steady_clock clock;
 
-  Element prod = GF256::neutral_mult_element ();
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    FixedReedSolomon<K, M>::encode (pointers.data (), pointers.data () + K, len);
+  auto fixed_dif = clock.now () - begin;
+  doNotOptimizeAway (shards[K][0]);
 
-  for (int i = 1; i <= 255; i++)
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    rs.encode (pointers.data (), pointers.data () + K, len);
+  auto dynamic_dif = clock.now () - begin;
+  doNotOptimizeAway (shards[K][0]);
+
+  printf ("  RS(%d, %d) %d KiB FixedReedSolomon time: %d\n", K, M, static_cast<int> (len >> 10), get_msecs (fixed_dif));
+  printf ("  RS(%d, %d) %d KiB ReedSolomon time: %d\n", K, M, static_cast<int> (len >> 10), get_msecs (dynamic_dif));
+}
+
+static void run_fixed_codec_benchmark ()
+{
+  printf ("SECTION: FIXED REED-SOLOMON\n");
+  printf ("  Encoding with the compile-time codec and with the dynamic one\n");
+
+  run_fixed_reed_solomon_benchmark<8, 3> (64 << 10, 2000);
+  run_fixed_reed_solomon_benchmark<12, 4> (64 << 10, 2000);
+  run_fixed_reed_solomon_benchmark<8, 3> (1 << 10, 200000);
+  run_fixed_reed_solomon_benchmark<12, 4> (1 << 10, 200000);
+  run_fixed_reed_solomon_benchmark<10, 6> (64 << 10, 1000);
+}
+
+static void run_bitmatrix_benchmark ()
+{
+  using namespace GF256;
+
+  const size_t len = 64 << 10;
+  const size_t packet_size = 1 << 10;
+  const int rounds = 2000;
+
+  printf ("SECTION: BITMATRIX CODEC\n");
+  printf ("  Encoding 64 KiB shards %d times with XOR schedules on %d-byte packets and with PSHUFB\n",
+          rounds, static_cast<int> (packet_size));
+
+  const int configs[][2] = {{8, 3}, {12, 4}};
+  for (const auto &config : configs)
     {
-      Element prev_prod = prod;
-      printf ("  x^%d = (%s) * x = %s", i,
-              to_string_as_polynom (prev_prod).c_str (),
-              to_string_as_polynom (prod *= root).c_str ());
+      const int k = config[0];
+      const int m = config[1];
+      ReedSolomon rs (k, m);
+      BitmatrixCodec codec (k, m, packet_size);
+      BitmatrixCodec plain (k, m, packet_size, false);
+
+      Shards shards = make_shards (k + m, len);
+      for (int i = 0; i < k; i++)
+        fill_random (shards[i]);
+      std::vector<Element *> pointers = shard_pointers (shards);
+
+      chr::steady_clock clock;
+
+      auto begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        codec.encode (pointers.data (), pointers.data () + k, len);
+      auto optimized_dif = clock.now () - begin;
+
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        plain.encode (pointers.data (), pointers.data () + k, len);
+      auto plain_dif = clock.now () - begin;
+
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        rs.encode (pointers.data (), pointers.data () + k, len);
+      auto pshufb_dif = clock.now () - begin;
+
+      printf ("  RS(%d, %d) optimized schedule (%d XORs) time: %d\n", k, m, codec.encode_schedule ().xor_count (),
+              get_msecs (optimized_dif));
+      printf ("  RS(%d, %d) plain schedule (%d XORs) time: %d\n", k, m, plain.encode_schedule ().xor_count (),
+              get_msecs (plain_dif));
+      printf ("  RS(%d, %d) PSHUFB time: %d\n", k, m, get_msecs (pshufb_dif));
+    }
+}
 
-      if (root.pow (i) != prod)
-        {
-          printf (" : ERROR\n");
-          printf ("SECTION RESULT: MULTIPLICATION: ERROR: multiplication produced wrong result\n");
-          return false;
-        }
-      else
-        printf (" : OK\n");
-      }
+static void run_bitplane_benchmark ()
+{
+  using namespace GF256;
 
-  printf ("SECTION RESULT: MULTIPLICATION: OK!\n");
+  const size_t len = 1 << 20;
+  const int rounds = 1000;
 
-  printf ("SECTION: INVERSE\n");
-  for (auto &&element : power_elements)
+  printf ("SECTION: BITPLANE\n");
+  printf ("  Converting 1 MiB to bit planes and back %d times\n", rounds);
+
+  std::vector<Element> src (len);
+  std::vector<Element> back (len);
+  fill_random (src);
+  std::vector<std::vector<unsigned char>> planes (8, std::vector<unsigned char> (len / 8));
+  std::vector<unsigned char *> plane_ptrs;
+  for (auto &plane : planes)
+    plane_ptrs.push_back (plane.data ());
+
+  for (BitplaneKernel kernel : bitplane_kernels)
     {
-      Element inverse = element.inv ();
-      Element prod = element * inverse;
-      printf ("  (%s)^-1 = %s\n", to_string_as_polynom (element).c_str (), to_string_as_polynom (inverse).c_str ());
-      printf ("  (%s) * (%s) = %s",
-              to_string_as_polynom (element).c_str (),
-              to_string_as_polynom (inverse).c_str (),
-              to_string_as_polynom (prod).c_str ());
+      if (!bitplane_kernel_supported (kernel))
+        continue;
 
-      if (prod == neutral_mult_element ())
-        printf (" : OK!\n");
-      else
-        {
-          printf (" : ERROR!\n");
-          printf ("SECTION RESULT: INVERSE: ERROR: inverse * base != 1\n");
-          return false;
-        }
+      chr::steady_clock clock;
 
-      auto it = inverse_elements.find (inverse);
-      if (it != inverse_elements.end ())
-        {
-          printf ("SECTION RESULT: INVERSE: ERROR: inverse operation is not biective\n");
-          return false;
-        }
+      auto begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        to_bitplanes (src.data (), plane_ptrs.data (), len, kernel);
+      auto to_dif = clock.now () - begin;
 
-      inverse_elements.insert (inverse);
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        from_bitplanes (plane_ptrs.data (), back.data (), len, kernel);
+      auto from_dif = clock.now () - begin;
+      doNotOptimizeAway (back[0]);
+
+      printf ("  %s to_bitplanes time: %d\n", bitplane_kernel_name (kernel), get_msecs (to_dif));
+      printf ("  %s from_bitplanes time: %d\n", bitplane_kernel_name (kernel), get_msecs (from_dif));
     }
+}
 
-  printf ("SECTION: DIVISION\n");
+static void run_constant_time_benchmark ()
+{
+  using namespace GF256;
 
-  Element div = GF256::neutral_mult_element ();
-  Element inverse_root = root.inv ();
-  for (int i = 1; i <= 255; i++)
+  const size_t len = 1 << 20;
+  const int rounds = 100;
+
+  printf ("SECTION: CONSTANT TIME\n");
+  printf ("  Multiplying 1 MiB element by element %d times\n", rounds);
+
+  std::vector<Element> a (len), b (len), dst (len);
+  fill_random (a);
+  fill_random (b);
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    ct::mul_region (a.data (), b.data (), dst.data (), len);
+  auto bitsliced_dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (size_t i = 0; i < len; i++)
+      dst[i] = ct::mul (a[i], b[i]);
+  auto scalar_dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (size_t i = 0; i < len; i++)
+      dst[i] = a[i] * b[i];
+  auto table_dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    ct::inv_region (a.data (), dst.data (), len);
+  auto inv_dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+
+  printf ("  bit-sliced ct::mul_region time: %d\n", get_msecs (bitsliced_dif));
+  printf ("  scalar ct::mul time: %d\n", get_msecs (scalar_dif));
+  printf ("  table operator * time: %d\n", get_msecs (table_dif));
+  printf ("  bit-sliced ct::inv_region time: %d\n", get_msecs (inv_dif));
+}
+
+// count x outputs matrix applied to shards of len bytes, tables against carry-less multiply
+static void run_clmul_case (int count, int outputs, size_t len, int rounds)
+{
+  using namespace GF256;
+
+  Shards srcs = make_shards (count, len);
+  Shards dsts = make_shards (outputs, len);
+  for (auto &src : srcs)
+    fill_random (src);
+  std::vector<Element> coefs (static_cast<size_t> (count) * outputs);
+  fill_random (coefs);
+
+  std::vector<const Element *> src_ptrs;
+  for (auto &src : srcs)
+    src_ptrs.push_back (src.data ());
+  std::vector<Element *> dst_ptrs = shard_pointers (dsts);
+  std::vector<NibbleTable> tables = make_nibble_tables (coefs.data (), coefs.size ());
+
+  chr::steady_clock clock;
+
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    dot_product_multi (tables.data (), src_ptrs.data (), count, dst_ptrs.data (), outputs, len);
+  auto table_dif = clock.now () - begin;
+  doNotOptimizeAway (dsts[0][0]);
+
+  printf ("  %dx%d matrix (%d KiB of tables), %d-byte shards:\n", outputs, count,
+          static_cast<int> (tables.size () * sizeof (NibbleTable) >> 10), static_cast<int> (len));
+  printf ("    tables time: %d\n", get_msecs (table_dif));
+
+  for (ClmulKernel kernel : clmul_kernels)
     {
-      Element prev_div = div;
-      printf ("  x^-%d = (%s) / x = %s", i,
-              to_string_as_polynom (prev_div).c_str (),
-              to_string_as_polynom (div /= root).c_str ());
+      if (kernel == ClmulKernel::none || !clmul_kernel_supported (kernel))
+        continue;
 
-      if (inverse_root.pow (i) != div)
-        {
-          printf (" : ERROR\n");
-          printf ("SECTION RESULT: DIVISION: ERROR: division produced wrong result\n");
-          return false;
-        }
-      else
-        printf (" : OK\n");
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        clmul_dot_product_multi (coefs.data (), src_ptrs.data (), count, dst_ptrs.data (), outputs, len, kernel);
+      auto clmul_dif = clock.now () - begin;
+      doNotOptimizeAway (dsts[0][0]);
+
+      printf ("    %s time: %d\n", clmul_kernel_name (kernel), get_msecs (clmul_dif));
     }
+}
 
-  printf ("SECTION RESULT: DIVISION: OK!\n");
+// dst = c * x + y^-1 over a buffer, the kind of loop Vec is written for
+template <int N>
+static void run_vec_case (const std::vector<GF256::Element> &x, const std::vector<GF256::Element> &y,
+                          std::vector<GF256::Element> &dst, int rounds)
+{
+  using namespace GF256;
 
-  printf ("SECTION: ADDITION\n");
+  const Element c (static_cast<unsigned char> (0x53));
+  std::span<const Element> xs (x), ys (y);
+  std::span<Element> ds (dst);
 
-  for (int max_i = 1; max_i <= 254; max_i++)
+  chr::steady_clock clock;
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (size_t i = 0; i < x.size (); i += N)
+      (Vec<N>::load (xs.subspan (i)) * c + Vec<N>::load (ys.subspan (i)).inv ()).store (ds.subspan (i));
+  auto dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+
+  printf ("  Vec<%d> time: %d\n", N, get_msecs (dif));
+}
+
+static void run_vec_benchmark ()
+{
+  using namespace GF256;
+
+  const size_t len = 1 << 20;
+  const int rounds = 100;
+
+  printf ("SECTION: VEC\n");
+  printf ("  dst = c * x + y^-1 over %d MiB %d times, Element loop against Vec<N>\n", static_cast<int> (len >> 20), rounds);
+
+  std::vector<Element> x (len), y (len), dst (len);
+  fill_random (x);
+  fill_random (y);
+  for (Element &e : y)
+    if (e == zero_element ())
+      e = neutral_mult_element ();
+
+  const Element c (static_cast<unsigned char> (0x53));
+  chr::steady_clock clock;
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (size_t i = 0; i < len; i++)
+      dst[i] = c * x[i] + y[i].inv ();
+  auto scalar_dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+
+  printf ("  Element time: %d\n", get_msecs (scalar_dif));
+  run_vec_case<16> (x, y, dst, rounds);
+  run_vec_case<32> (x, y, dst, rounds);
+  run_vec_case<64> (x, y, dst, rounds);
+}
+
+static void run_buffer_benchmark ()
+{
+  using namespace GF256;
+
+  const size_t len = 1 << 20;
+  const int rounds = 200;
+
+  printf ("SECTION: BUFFER\n");
+  printf ("  z = a * x + b * y + w over %d MiB %d times\n", static_cast<int> (len >> 20), rounds);
+
+  std::vector<Element> values (len);
+  fill_random (values);
+  Buffer x (values);
+  fill_random (values);
+  Buffer y (values);
+  fill_random (values);
+  Buffer w (values);
+  Buffer z (len), temp (len);
+  const Element a (static_cast<unsigned char> (0x1d));
+  const Element b (static_cast<unsigned char> (0xe7));
+
+  chr::steady_clock clock;
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    z = a * x + b * y + w;
+  auto expression_dif = clock.now () - begin;
+  doNotOptimizeAway (z[0]);
+
+  // what operators returning whole buffers would do: a pass per operation
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
     {
-      Element sum;
-      for (int i = 0; i <= max_i; i++)
-        sum += root.pow (i);
+      mul_region (a, x.data (), z.data (), len);
+      mul_region (b, y.data (), temp.data (), len);
+      add_region (temp.data (), z.data (), len);
+      add_region (w.data (), z.data (), len);
+    }
+  auto passes_dif = clock.now () - begin;
+  doNotOptimizeAway (z[0]);
 
-      Element power = root.pow (max_i + 1);
-      Element numerator = power - 1;
-      Element denomenator = root - 1;
+  const Element coefs[] = {a, b, neutral_mult_element ()};
+  const Element *srcs[] = {x.data (), y.data (), w.data ()};
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    dot_product (coefs, srcs, 3, z.data (), len);
+  auto fused_dif = clock.now () - begin;
+  doNotOptimizeAway (z[0]);
+
+  printf ("  expression template time: %d\n", get_msecs (expression_dif));
+  printf ("  one pass per operation time: %d\n", get_msecs (passes_dif));
+  printf ("  hand-fused dot_product time: %d\n", get_msecs (fused_dif));
+}
 
-      Element must_be_sum = numerator / denomenator;
-      printf ("  1 + ... + x^%d = %s", max_i, to_string_as_polynom (sum).c_str ());
+static void run_clmul_benchmark ()
+{
+  printf ("SECTION: CLMUL\n");
+  printf ("  Matrix times shards with NibbleTables and with carry-less multiply\n");
 
-      if (sum != must_be_sum)
-        {
-          printf (" : ERROR\n");
-          printf ("SECTION RESULT: ADDITION: ERROR: addition produced wrong result\n");
-          return false;
-        }
-      else
-        printf (" : OK\n");
+  run_clmul_case (8, 3, 64 << 10, 2000);
+  run_clmul_case (64, 64, 4 << 10, 100);
+  run_clmul_case (128, 128, 1 << 10, 50);
+}
+
+static void run_gemm_benchmark ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: GEMM\n");
+
+  // many stripes encoded as one product: row j of B holds data shard j of every stripe
+  const int k = 10;
+  const int m = 4;
+  const size_t stripes = 256;
+  const size_t len = 4 << 10;
+  const int rounds = 20;
+  printf ("  RS(%d, %d) parity of %d stripes of %d-byte shards %d times\n", k, m, static_cast<int> (stripes),
+          static_cast<int> (len), rounds);
+
+  ReedSolomon rs (k, m);
+  const Element *coefs = rs.encode_matrix ().row (k);
+  std::vector<Element> data (k * stripes * len), parity (m * stripes * len);
+  fill_random (data);
+
+  chr::steady_clock clock;
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    for (size_t s = 0; s < stripes; s++)
+      {
+        const Element *srcs[k];
+        Element *dsts[m];
+        for (int j = 0; j < k; j++)
+          srcs[j] = data.data () + (j * stripes + s) * len;
+        for (int o = 0; o < m; o++)
+          dsts[o] = parity.data () + (o * stripes + s) * len;
+        dot_product_multi (rs.parity_tables (), srcs, dsts, len);
+      }
+  auto stripe_dif = clock.now () - begin;
+  doNotOptimizeAway (parity[0]);
+
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    gemm (m, k, stripes * len, coefs, k, data.data (), stripes * len, parity.data (), stripes * len);
+  auto gemm_dif = clock.now () - begin;
+  doNotOptimizeAway (parity[0]);
+
+  begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    gemm (m, k, stripes * len, coefs, k, data.data (), stripes * len, parity.data (), stripes * len, false, 0);
+  auto threads_dif = clock.now () - begin;
+  doNotOptimizeAway (parity[0]);
+
+  printf ("  dot_product_multi per stripe time: %d\n", get_msecs (stripe_dif));
+  printf ("  gemm time: %d\n", get_msecs (gemm_dif));
+  printf ("  gemm on %d threads time: %d\n", static_cast<int> (std::max (1u, std::thread::hardware_concurrency ())),
+          get_msecs (threads_dif));
+
+  // square products, against a mul_add_region per element of the left matrix
+  const int n = 512;
+  printf ("  %dx%d matrix product\n", n, n);
+  Matrix a (n, n), b (n, n), c (n, n);
+  std::vector<Element> values (n * n);
+  fill_random (values);
+  std::copy (values.begin (), values.end (), a.row (0));
+  fill_random (values);
+  std::copy (values.begin (), values.end (), b.row (0));
+
+  begin = clock.now ();
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      mul_add_region (a (i, j), b.row (j), c.row (i), n);
+  auto rows_dif = clock.now () - begin;
+  doNotOptimizeAway (c (0, 0));
+
+  begin = clock.now ();
+  gemm (n, n, n, a.row (0), n, b.row (0), n, c.row (0), n);
+  auto product_dif = clock.now () - begin;
+  doNotOptimizeAway (c (0, 0));
+
+  printf ("  mul_add_region per element time: %d\n", get_msecs (rows_dif));
+  printf ("  gemm time: %d\n", get_msecs (product_dif));
+}
+
+static void run_greased_benchmark ()
+{
+  using namespace GF256;
+
+  printf ("SECTION: GREASED\n");
+  printf ("  Four Russians tables against gemm and plain Gauss-Jordan elimination\n");
+
+  for (int n : {128, 256, 512, 1024})
+    {
+      Matrix a (n, n), b (n, n), c (n, n);
+      std::vector<Element> values (n * n);
+      fill_random (values);
+      std::copy (values.begin (), values.end (), a.row (0));
+      fill_random (values);
+      std::copy (values.begin (), values.end (), b.row (0));
+
+      chr::steady_clock clock;
+      auto begin = clock.now ();
+      gemm (n, n, n, a.row (0), n, b.row (0), n, c.row (0), n);
+      auto gemm_dif = clock.now () - begin;
+      doNotOptimizeAway (c (0, 0));
+
+      begin = clock.now ();
+      greased_multiply (n, n, n, a.row (0), n, b.row (0), n, c.row (0), n);
+      auto multiply_dif = clock.now () - begin;
+      doNotOptimizeAway (c (0, 0));
+
+      begin = clock.now ();
+      auto plain = a.inverse (false);
+      auto plain_dif = clock.now () - begin;
+
+      begin = clock.now ();
+      auto greased = a.inverse ();
+      auto greased_dif = clock.now () - begin;
+
+      printf ("  %dx%d:\n", n, n);
+      printf ("    gemm time: %d\n", get_msecs (gemm_dif));
+      printf ("    greased_multiply time: %d\n", get_msecs (multiply_dif));
+      printf ("    plain inverse time: %d\n", get_msecs (plain_dif));
+      printf ("    greased inverse time: %d\n", get_msecs (greased_dif));
     }
+}
 
-  printf ("SECTION RESULT: ADDITION: OK!\n");
-  return true;
+static void run_sparse_benchmark ()
+{
+  using namespace GF256;
+
+  const int n = 2000;
+  const size_t len = 1024;
+  printf ("SECTION: SPARSE\n");
+  printf ("  %dx%d systems with %d-byte payloads, sparse against dense\n", n, n, static_cast<int> (len));
+
+  for (int per_row : {5, 20})
+    {
+      SparseMatrix a = random_sparse (n, n, per_row);
+      Shards payloads = make_shards (n, len), solved = make_shards (n, len);
+      for (auto &payload : payloads)
+        fill_random (payload);
+      std::vector<const Element *> payload_ptrs;
+      for (auto &payload : payloads)
+        payload_ptrs.push_back (payload.data ());
+
+      chr::steady_clock clock;
+      auto begin = clock.now ();
+      std::vector<Element> x (n), y (n);
+      for (int r = 0; r < 100; r++)
+        a.multiply (x.data (), y.data ());
+      auto spmv_dif = clock.now () - begin;
+      doNotOptimizeAway (y[0]);
+
+      begin = clock.now ();
+      a.multiply (payload_ptrs.data (), shard_pointers (solved).data (), len);
+      auto spmm_dif = clock.now () - begin;
+      doNotOptimizeAway (solved[0][0]);
+
+      Matrix dense = a.to_dense ();
+      begin = clock.now ();
+      gemm (n, n, len, dense.row (0), n, payload_ptrs.data (), shard_pointers (solved).data ());
+      auto gemm_dif = clock.now () - begin;
+      doNotOptimizeAway (solved[0][0]);
+
+      begin = clock.now ();
+      bool solvable = sparse_solve (a, payload_ptrs.data (), shard_pointers (solved).data (), len);
+      auto sparse_dif = clock.now () - begin;
+      doNotOptimizeAway (solvable);
+
+      begin = clock.now ();
+      auto inverse = dense.inverse ();
+      if (inverse)
+        gemm (n, n, len, inverse->row (0), n, payload_ptrs.data (), shard_pointers (solved).data ());
+      auto dense_dif = clock.now () - begin;
+      doNotOptimizeAway (solved[0][0]);
+
+      printf ("  %d nonzeros (%.1f%%), %d KiB sparse and %d KiB dense:\n", static_cast<int> (a.nonzeros ()),
+              100.0 * a.nonzeros () / n / n, static_cast<int> (a.nonzeros () * (sizeof (int) + sizeof (Element)) >> 10),
+              static_cast<int> (static_cast<size_t> (n) * n >> 10));
+      printf ("    100 SpMV time: %d\n", get_msecs (spmv_dif));
+      printf ("    SpMM time: %d\n", get_msecs (spmm_dif));
+      printf ("    dense gemm time: %d\n", get_msecs (gemm_dif));
+      printf ("    sparse_solve time: %d\n", get_msecs (sparse_dif));
+      printf ("    dense inverse and gemm time: %d\n", get_msecs (dense_dif));
+    }
+}
+
+static void run_tower_benchmark ()
+{
+  using namespace GF256;
+
+  const int k = 300;
+  const int m = 12;
+  const size_t len = 16 << 10;
+  const size_t symbols = len / GF65536::degree;
+  printf ("SECTION: TOWER\n");
+  printf ("  RS(%d, %d) over GF65536, %d KiB shards\n", k, m, static_cast<int> (len >> 10));
+
+  WideReedSolomon<GF65536> rs (k, m);
+  Shards shards = make_shards (k + m, len);
+  for (int i = 0; i < k; i++)
+    fill_random (shards[i]);
+  std::vector<Element *> ptrs = shard_pointers (shards);
+
+  chr::steady_clock clock;
+  auto begin = clock.now ();
+  rs.encode (ptrs.data (), ptrs.data () + k, len);
+  auto encode_dif = clock.now () - begin;
+  doNotOptimizeAway (shards[k][0]);
+
+  // the same parity symbol by symbol with the field operations
+  std::vector<GF65536> coefs;
+  for (int i = 0; i < m; i++)
+    for (int j = 0; j < k; j++)
+      coefs.push_back (rs.coefficient (i, j));
+  begin = clock.now ();
+  for (int i = 0; i < m; i++)
+    for (size_t s = 0; s < symbols; s++)
+      {
+        GF65536 sum;
+        for (int j = 0; j < k; j++)
+          sum += coefs[i * k + j] * GF65536 (shards[j][s], shards[j][symbols + s]);
+        shards[k + i][s] = sum.low ();
+        shards[k + i][symbols + s] = sum.high ();
+      }
+  auto scalar_dif = clock.now () - begin;
+  doNotOptimizeAway (shards[k][0]);
+
+  std::vector<bool> present (k + m, true);
+  for (int i = 0; i < m; i++)
+    present[i * 7] = false;
+  begin = clock.now ();
+  rs.reconstruct (ptrs.data (), present, len);
+  auto first_dif = clock.now () - begin;
+  doNotOptimizeAway (shards[0][0]);
+
+  begin = clock.now ();
+  rs.reconstruct (ptrs.data (), present, len);
+  auto cached_dif = clock.now () - begin;
+  doNotOptimizeAway (shards[0][0]);
+
+  printf ("  encode over GF256 planes time: %d\n", get_msecs (encode_dif));
+  printf ("  encode symbol by symbol time: %d\n", get_msecs (scalar_dif));
+  printf ("  reconstruct %d data shards time: %d\n", m, get_msecs (first_dif));
+  printf ("  reconstruct with cached decoder time: %d\n", get_msecs (cached_dif));
+}
+
+static void run_basis_benchmark ()
+{
+  using namespace GF256;
+
+  const size_t len = 16 << 20;
+  const int rounds = 16;
+  printf ("SECTION: BASIS\n");
+  printf ("  Converting 16 MiB to the AES representation %d times, and multiplying it\n", rounds);
+
+  std::vector<Element> src (len);
+  std::vector<Element> other (len);
+  std::vector<Element> dst (len);
+  fill_random (src);
+  fill_random (other);
+  const Element coef (static_cast<unsigned char> (0x9d));
+
+  chr::steady_clock clock;
+  auto begin = clock.now ();
+  for (int r = 0; r < rounds; r++)
+    mul_region (coef, src.data (), dst.data (), len);
+  auto bulk_dif = clock.now () - begin;
+  doNotOptimizeAway (dst[0]);
+  printf ("  bulk mul_region time: %d\n", get_msecs (bulk_dif));
+
+  for (BasisKernel kernel : basis_kernels)
+    {
+      if (!basis_kernel_supported (kernel))
+        continue;
+
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        to_basis (aes_polynomial, src.data (), bulk_impl::bytes (dst.data ()), len, kernel);
+      auto convert_dif = clock.now () - begin;
+      doNotOptimizeAway (dst[0]);
+
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        affine_mul_region (coef, src.data (), dst.data (), len, kernel);
+      auto affine_dif = clock.now () - begin;
+      doNotOptimizeAway (dst[0]);
+
+      begin = clock.now ();
+      for (int r = 0; r < rounds; r++)
+        mul_lanes (src.data (), other.data (), dst.data (), len, kernel);
+      auto lanes_dif = clock.now () - begin;
+      doNotOptimizeAway (dst[0]);
+
+      printf ("  %s to_basis time: %d\n", basis_kernel_name (kernel), get_msecs (convert_dif));
+      printf ("  %s affine_mul_region time: %d\n", basis_kernel_name (kernel), get_msecs (affine_dif));
+      printf ("  %s mul_lanes time: %d\n", basis_kernel_name (kernel), get_msecs (lanes_dif));
+    }
 }
 
 void GF256::run_benchmark_suit ()
@@ -308,5 +3658,29 @@ void GF256::run_benchmark_suit ()
   printf ("  GF256 time: %d\n", get_msecs (my_dif));
   printf ("  gf256-3rd-party time: %d\n", get_msecs (his_dif));
 
+  run_repair_benchmark ();
+  run_regenerating_benchmark ();
+  run_partial_write_benchmark ();
+  run_degraded_read_benchmark ();
+  run_scrub_benchmark ();
+  run_checksummed_encode_benchmark ();
+  run_stream_encoder_benchmark ();
+  run_shard_io_benchmark ();
+  run_async_codec_benchmark ();
+  run_small_object_benchmark ();
+  run_jit_encoder_benchmark ();
+  run_fixed_codec_benchmark ();
+  run_bitmatrix_benchmark ();
+  run_bitplane_benchmark ();
+  run_constant_time_benchmark ();
+  run_clmul_benchmark ();
+  run_vec_benchmark ();
+  run_buffer_benchmark ();
+  run_gemm_benchmark ();
+  run_greased_benchmark ();
+  run_sparse_benchmark ();
+  run_tower_benchmark ();
+  run_basis_benchmark ();
+
   return;
 }